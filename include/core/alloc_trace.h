@@ -0,0 +1,51 @@
+#pragma once
+#include "core/common.h"
+#include <cstdint>
+
+namespace infini
+{
+  class Allocator;
+
+  // One call to Allocator::alloc or Allocator::free.
+  struct AllocEvent
+  {
+    bool isFree;
+    // numbers the blocks in allocation order, a free names the block it ends
+    uint64_t id;
+    // bytes requested, before alignment
+    uint64_t size;
+    // guid of the operator whose step made the call, 0 for graph inputs
+    uint64_t tag;
+  };
+
+  /**
+   * @brief The alloc/free sequence of an Allocator, which can be saved to a
+   * file and replayed against any AllocStrategy outside of the model.
+   *
+   * The file is the magic "ITAT", a version and the alignment, followed by
+   * the events as LEB128 varints. Frees omit the size of their block.
+   */
+  class AllocTrace
+  {
+    size_t alignment;
+    vector<AllocEvent> events;
+
+  public:
+    static constexpr uint32_t version = 1;
+
+    explicit AllocTrace(size_t alignment) : alignment(alignment) {}
+
+    void addAlloc(uint64_t id, uint64_t size, uint64_t tag);
+    void addFree(uint64_t id, uint64_t tag);
+
+    size_t getAlignment() const { return alignment; }
+    const vector<AllocEvent> &getEvents() const { return events; }
+
+    void save(const string &path) const;
+    static AllocTrace load(const string &path);
+
+    // function: issue the recorded calls on 'allocator'
+    // return: the peak of the resulting plan
+    size_t replay(Allocator &allocator) const;
+  };
+} // namespace infini
@@ -1,4 +1,5 @@
 #pragma once
+#include "core/alloc_trace.h"
 #include "core/runtime.h"
 #include "core/tensor.h"
 #ifdef BUILD_TEST
@@ -6,9 +7,123 @@
 #endif
 #include <cstddef>
 #include <map>
+#include <set>
 #include <unordered_set>
 
 namespace infini {
+  /**
+   * @brief Free blocks ordered by address in a treap whose nodes also know
+   * the largest block of their subtree, so the lowest-address block of at
+   * least a given size is found in O(log n).
+   */
+  class FreeBlockTree
+  {
+    struct Node
+    {
+      size_t addr, size;
+      // the largest size in the subtree rooted here
+      size_t maxSize;
+      uint32_t priority;
+      int left, right;
+    };
+    // nodes are indexed rather than pointed to, so the tree can be copied
+    vector<Node> nodes;
+    vector<int> unused;
+    int root = -1;
+    uint32_t seed = 2463534242u;
+
+  public:
+    void insert(size_t addr, size_t size);
+    void erase(size_t addr);
+    // function: move and resize the block at 'addr' in place
+    // 'newAddr' must keep it between the same neighbours
+    void move(size_t addr, size_t newAddr, size_t size);
+    // function: find the block at the lowest address of at least 'size' bytes
+    // return: its address, or nullopt if no block is large enough
+    optional<size_t> firstFit(size_t size) const;
+
+  private:
+    size_t maxSize(int t) const { return t < 0 ? 0 : nodes[t].maxSize; }
+    void update(int t);
+    // return: the new root of subtree 't'
+    int insert(int t, int node);
+    int erase(int t, size_t addr);
+    void move(int t, size_t addr, size_t newAddr, size_t size);
+    // splits 't' into the nodes below 'addr' and the others
+    void split(int t, size_t addr, int &below, int &rest);
+    int merge(int a, int b);
+  };
+
+  // Free blocks of an Allocator, indexed three ways and kept in sync.
+  struct FreeBlocks
+  {
+    // address -> size
+    std::map<size_t, size_t> byAddr;
+    // (size, address)
+    std::set<std::pair<size_t, size_t>> bySize;
+    // by address, searchable by size
+    FreeBlockTree tree;
+  };
+
+  /**
+   * @brief Placement policy of Allocator::alloc: which free block serves a
+   * request, or none to grow the arena.
+   */
+  class AllocStrategy
+  {
+  public:
+    virtual ~AllocStrategy() {}
+
+    // function: round an aligned request up to the size actually reserved
+    virtual size_t roundSize(size_t size) const { return size; }
+
+    // function: pick a free block of at least 'size' bytes
+    // return: its address, or nullopt if the arena should grow
+    virtual optional<size_t> find(const FreeBlocks &blocks,
+                                  size_t size) const = 0;
+
+    virtual string toString() const = 0;
+  };
+
+  // The block at the lowest address, in O(log n). This is the default.
+  class FirstFitStrategy : public AllocStrategy
+  {
+  public:
+    optional<size_t> find(const FreeBlocks &blocks,
+                          size_t size) const override;
+    string toString() const override { return "FirstFit"; }
+  };
+
+  // The smallest block, in O(log n).
+  class BestFitStrategy : public AllocStrategy
+  {
+  public:
+    optional<size_t> find(const FreeBlocks &blocks,
+                          size_t size) const override;
+    string toString() const override { return "BestFit"; }
+  };
+
+  // The largest block, leaving the largest remainder behind.
+  class WorstFitStrategy : public AllocStrategy
+  {
+  public:
+    optional<size_t> find(const FreeBlocks &blocks,
+                          size_t size) const override;
+    string toString() const override { return "WorstFit"; }
+  };
+
+  // Requests are rounded up to size classes, four per power of two, so
+  // freed blocks are reused by any request of the same class. The smallest
+  // block of the smallest class large enough is taken.
+  class SizeClassStrategy : public AllocStrategy
+  {
+  public:
+    size_t roundSize(size_t size) const override;
+    optional<size_t> find(const FreeBlocks &blocks,
+                          size_t size) const override;
+    string toString() const override { return "SizeClass"; }
+  };
+
   class Allocator
   {
   private:
@@ -23,15 +138,40 @@ namespace infini {
     // pointer to the memory actually allocated
     void *ptr;
 
+    // owns 'ptr': blobs placed in the arena share it, see getArena
+    Ref<void> arena;
+
     // =================================== 作业 ===================================
     // TODO：可能需要设计一个数据结构来存储free block，以便于管理和合并
     // HINT: 可以使用一个 map 来存储 free block，key 为 block 的起始/结尾地址，value 为 block 的大小
     // =================================== 作业 ===================================
 
-std::map<size_t, size_t> freeBlockMap;
+    FreeBlocks freeBlocks;
+
+    Ref<AllocStrategy> strategy;
+
+    // bytes requested by the live blocks, before the strategy rounds them
+    size_t live;
+
+    // the maximum of 'live': no placement can need a smaller arena
+    size_t maxLive;
+
+    // the calls recorded since startTrace, null when not recording
+    Ref<AllocTrace> trace;
+
+    // attached to the recorded calls, see setTraceTag
+    uint64_t traceTag;
+
+    // offset of a live block -> its id in the trace
+    std::unordered_map<size_t, uint64_t> traceIds;
+    uint64_t nextTraceId;
 
   public:
-    Allocator(Runtime runtime);
+    // Cache-line size, which also covers the widest (AVX-512) vector loads.
+    static constexpr size_t defaultAlignment = 64;
+
+    // alignment: every block starts at a multiple of it, must be a power of 2
+    Allocator(Runtime runtime, size_t alignment = defaultAlignment);
 
     virtual ~Allocator();
 
@@ -51,11 +191,43 @@ std::map<size_t, size_t> freeBlockMap;
     // return: pointer to the head address of the allocated memory
     void *getPtr();
 
+    // the memory returned by getPtr: holding it keeps the memory alive after
+    // the allocator is gone, e.g. while a tensor is exported through DLPack
+    Ref<void> getArena() const { return arena; }
+
+    // print usage and fragmentation statistics of the plan
     void info();
 
+    void setStrategy(Ref<AllocStrategy> strategy);
+    Ref<AllocStrategy> getStrategy() const { return strategy; }
+
+    size_t getAlignment() const { return alignment; }
+    size_t getPeak() const { return peak; }
+    size_t getLowerBound() const { return maxLive; }
+    size_t getFreeBlockCount() const { return freeBlocks.byAddr.size(); }
+    size_t getLargestFreeBlock() const;
+
+    // Record the following alloc and free calls, see AllocTrace.
+    void startTrace();
+    Ref<AllocTrace> getTrace() const { return trace; }
+
+    // The calls recorded from now on are attributed to 'tag', usually the
+    // guid of the operator being planned.
+    void setTraceTag(uint64_t tag) { traceTag = tag; }
+
   private:
     // function: memory alignment, rouned up
     // return: size of the aligned memory block
     size_t getAlignedSize(size_t size);
+
+    // function: place an aligned block per 'strategy', without tracing
+    size_t allocBlock(size_t size);
+
+    // keep the indexes of freeBlocks in sync
+    void insertFreeBlock(size_t addr, size_t size);
+    void eraseFreeBlock(std::map<size_t, size_t>::iterator it);
+    // like erase then insert, for a block that keeps its neighbours
+    void moveFreeBlock(std::map<size_t, size_t>::iterator it, size_t addr,
+                       size_t size);
   };
 }
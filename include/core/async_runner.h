@@ -0,0 +1,86 @@
+#pragma once
+#include "core/execution_context.h"
+#include <future>
+
+namespace infini
+{
+  /**
+   * @brief Runs one graph asynchronously on a pool of worker threads, so that
+   * callers can prepare the next requests while earlier ones compute.
+   *
+   * Each worker owns an execution context of the graph, so up to 'workers'
+   * requests run at once and the rest wait in a queue of at most 'capacity'
+   * requests; submit blocks while the queue is full. When a request starts,
+   * its buffers for inputs and outputs made external by
+   * GraphObj::setExternal are bound to the worker's context and used in
+   * place; the others are copied into the context before the run and out
+   * of it after. Then the request completes its future.
+   */
+  class AsyncRunnerObj
+  {
+  public:
+    // A submitted request: its id, for cancel, and its completion.
+    struct Ticket
+    {
+      uint64_t id;
+      std::future<void> future;
+    };
+
+  private:
+    struct Request
+    {
+      uint64_t id;
+      vector<const void *> inputs;
+      vector<void *> outputs;
+      std::promise<void> done;
+    };
+
+    Graph graph;
+    TensorVec inputs, outputs;
+    size_t capacity;
+
+    std::mutex lock;
+    // Signalled when a request is queued and when one leaves the queue.
+    std::condition_variable queued, dequeued;
+    std::deque<Request> queue;
+    uint64_t nextId = 0;
+    size_t running = 0;
+    bool stopping = false;
+    vector<std::thread> workers;
+
+  public:
+    /**
+     * @brief 'graph' must have been planned by dataMalloc. 'inputs' and
+     * 'outputs' are the tensors of it that requests provide and receive.
+     */
+    AsyncRunnerObj(Graph graph, TensorVec inputs, TensorVec outputs,
+                   int workers = 2, size_t capacity = 16);
+    // Cancels the queued requests and waits for the running ones.
+    ~AsyncRunnerObj();
+    AsyncRunnerObj(const AsyncRunnerObj &) = delete;
+    AsyncRunnerObj &operator=(const AsyncRunnerObj &) = delete;
+
+    /**
+     * @brief Queue a run. 'inputs' and 'outputs' point to the data of each of
+     * the runner's inputs and outputs, in their order, and must stay valid
+     * until the future completes. The future throws if the run failed or was
+     * cancelled.
+     */
+    Ticket submit(vector<const void *> inputs, vector<void *> outputs);
+
+    /**
+     * @brief Cancel the request 'id' if it has not started. Returns whether
+     * it was cancelled.
+     */
+    bool cancel(uint64_t id);
+
+    // Requests queued or running.
+    size_t pending();
+
+  private:
+    // Body of a worker thread.
+    void loop(ExecutionContext context);
+  };
+
+  using AsyncRunner = Ref<AsyncRunnerObj>;
+} // namespace infini
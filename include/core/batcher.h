@@ -0,0 +1,113 @@
+#pragma once
+#include "core/graph.h"
+#include <chrono>
+#include <functional>
+#include <future>
+#include <map>
+
+namespace infini
+{
+  /**
+   * @brief A graph whose 'inputs' and 'outputs' carry a leading batch
+   * dimension. Other tensors, such as weights, are not batched.
+   */
+  struct BatchedGraph
+  {
+    Graph graph;
+    TensorVec inputs, outputs;
+  };
+
+  /**
+   * @brief Collects concurrent requests for one model into batched runs.
+   *
+   * A worker thread takes the oldest pending requests, up to 'maxBatch' of
+   * them, as soon as that many are queued or the oldest has waited
+   * 'maxDelay'. Their samples are concatenated along the batch dimension into
+   * the inputs of the graph built for that batch size, which is run once,
+   * and the outputs are split back into the requests' buffers before their
+   * futures complete.
+   *
+   * Graphs are built by 'build' on first use of each batch size and kept, so
+   * a builder should share the weights between them, e.g. by binding them
+   * with setExternalBlob.
+   */
+  class BatcherObj
+  {
+  public:
+    using Builder = std::function<BatchedGraph(int batch)>;
+    using Clock = std::chrono::steady_clock;
+
+    // Per-request latencies, from submit to completion, and batch sizes.
+    struct Stats
+    {
+      size_t requests = 0, batches = 0;
+      // From the first submit to the last completion.
+      double seconds = 0;
+      // Latencies in ms, counted in buckets growing by 2^(1/16), about 4.4%,
+      // from 1 us up, so the stats keep a fixed size however long they run.
+      static constexpr double minBucket = 1e-3;
+      static constexpr int bucketsPerOctave = 16, nBuckets = 40 * 16;
+      vector<size_t> histogram = vector<size_t>(nBuckets);
+      double minLatency = 0, maxLatency = 0;
+
+      void record(double ms);
+      // Requests completed per second.
+      double throughput() const;
+      double meanBatch() const;
+      // The latency below which a fraction 'p' of the requests completed,
+      // to within a bucket, and exact at 0 and 1.
+      double percentile(double p) const;
+      string toString() const;
+    };
+
+  private:
+    struct Request
+    {
+      vector<const void *> inputs;
+      vector<void *> outputs;
+      std::promise<void> done;
+      Clock::time_point arrival;
+    };
+
+    Builder build;
+    int maxBatch;
+    Clock::duration maxDelay;
+    std::map<int, BatchedGraph> graphs;
+    // Bytes of one sample of each input and output, from the batch-1 graph.
+    vector<size_t> inputBytes, outputBytes;
+
+    std::mutex lock;
+    std::condition_variable cond;
+    std::deque<Request> queue;
+    bool stopping = false;
+    Stats stats;
+    Clock::time_point first;
+    std::thread worker;
+
+  public:
+    BatcherObj(Builder build, int maxBatch, Clock::duration maxDelay);
+    // Completes the pending requests, then stops the worker.
+    ~BatcherObj();
+    BatcherObj(const BatcherObj &) = delete;
+    BatcherObj &operator=(const BatcherObj &) = delete;
+
+    /**
+     * @brief Queue one sample. 'inputs' and 'outputs' point to a sample of
+     * each batched input and output, in their order, and must stay valid
+     * until the future completes. The future throws if the run failed.
+     */
+    std::future<void> submit(vector<const void *> inputs,
+                             vector<void *> outputs);
+
+    Stats getStats();
+    void resetStats();
+
+  private:
+    // Body of the worker thread.
+    void loop();
+    const BatchedGraph &graphFor(int batch);
+    void runBatch(vector<Request> &batch);
+  };
+
+  using Batcher = Ref<BatcherObj>;
+} // namespace infini
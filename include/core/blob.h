@@ -11,9 +11,12 @@ class BlobObj
 {
   Runtime runtime;
   void *ptr;
+  // Keeps the memory 'ptr' points into alive, e.g. a mapped model file.
+  Ref<void> owner;
 
 public:
-  BlobObj(Runtime runtime, void *ptr) : runtime(runtime), ptr(ptr) {}
+  BlobObj(Runtime runtime, void *ptr, Ref<void> owner = nullptr)
+      : runtime(runtime), ptr(ptr), owner(std::move(owner)) {}
   BlobObj(BlobObj &other) = delete;
   BlobObj &operator=(BlobObj const &) = delete;
   ~BlobObj() {};
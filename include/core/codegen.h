@@ -0,0 +1,74 @@
+#pragma once
+#include "core/graph.h"
+
+namespace infini
+{
+  /**
+   * @brief Emit a standalone C++ source that computes 'graph', which
+   * dataMalloc has planned, for deployment without this library.
+   *
+   * The source defines
+   *
+   *   extern "C" void infer(const void *in, void *out);
+   *
+   * where 'in' holds the data of 'inputs' and 'out' receives the data of
+   * 'outputs', each packed one after the other in their order. The arena is
+   * a static array of the planned size, every tensor is a constant offset
+   * into it, into 'in' or 'out', or into a weight embedded as a constant
+   * array, and every operator is a loop nest over its constant shape and
+   * strides, so the compiler can specialize it. Weights planned in the
+   * arena are embedded too, and copied into it at the start of infer. The
+   * arena makes infer not reentrant.
+   *
+   * Every tensor must be bound, including the external inputs and outputs,
+   * whose memory is then read and written through 'in' and 'out' directly.
+   */
+  string generateCpp(const Graph &graph, const TensorVec &inputs,
+                     const TensorVec &outputs);
+
+  // Building blocks of generated sources, shared with the JIT, see jit.h.
+
+  // The C++ type of the elements of 'dtype'.
+  string cTypeOf(DataType dtype);
+  // A float literal that reads back exactly.
+  string floatLiteral(float value);
+
+  /**
+   * @brief The expression computing one element of the output of 'op', an
+   * element-wise operator, Relu or Clip, from the expressions 'args' of the
+   * elements of its inputs. Arguments may appear more than once.
+   */
+  string elementExpr(const Operator &op, const vector<string> &args);
+
+  // An operand of a loop nest: the name of its pointer and its stride in
+  // elements along each loop dimension.
+  struct LoopOperand
+  {
+    string ptr;
+    Shape stride;
+  };
+
+  // The strides of 'tensor' read along 'dims', which it broadcasts to.
+  Shape broadcastStride(const Tensor &tensor, const Shape &dims);
+
+  /**
+   * @brief Emit loops over 'dims' that assign 'expr' to each element of
+   * operands[0], where $k in 'expr' stands for the element of operands[k].
+   * The statements 'lets' come first in the innermost body, with $k replaced
+   * as well. Dimensions that all operands walk contiguously are merged, so
+   * plain element-wise ops become a single loop. 'indent' is the number of
+   * spaces of the outermost loop.
+   */
+  void emitLoops(std::ostream &os, const Shape &dims,
+                 const vector<LoopOperand> &operands, string expr,
+                 const vector<string> &lets = {}, int indent = 8);
+
+  /**
+   * @brief Build 'source' into the shared object 'library' with 'compiler',
+   * passing 'flags'. The source is kept next to it, as 'library'.cc.
+   * 'compiler' and 'flags' are split into arguments at whitespace, and the
+   * compiler is run directly, without a shell.
+   */
+  void compileCpp(const string &source, const string &library,
+                  const string &compiler = "c++", const string &flags = "-O3");
+} // namespace infini
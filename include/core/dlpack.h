@@ -0,0 +1,86 @@
+#pragma once
+#include "core/graph.h"
+
+// The DLPack ABI (v0.8), see https://github.com/dmlc/dlpack. The structures
+// are spelled out here so that no header has to be installed; when the
+// official dlpack.h is included first, its definitions are used instead.
+#ifndef DLPACK_VERSION
+extern "C"
+{
+  typedef enum
+  {
+    kDLCPU = 1,
+    kDLCUDA = 2,
+    kDLCUDAHost = 3,
+  } DLDeviceType;
+
+  typedef struct
+  {
+    DLDeviceType device_type;
+    int32_t device_id;
+  } DLDevice;
+
+  typedef enum
+  {
+    kDLInt = 0U,
+    kDLUInt = 1U,
+    kDLFloat = 2U,
+    kDLOpaqueHandle = 3U,
+    kDLBfloat = 4U,
+    kDLComplex = 5U,
+    kDLBool = 6U,
+  } DLDataTypeCode;
+
+  typedef struct
+  {
+    uint8_t code;
+    uint8_t bits;
+    uint16_t lanes;
+  } DLDataType;
+
+  typedef struct
+  {
+    void *data;
+    DLDevice device;
+    int32_t ndim;
+    DLDataType dtype;
+    int64_t *shape;
+    // In elements, null for a compact row-major tensor.
+    int64_t *strides;
+    uint64_t byte_offset;
+  } DLTensor;
+
+  typedef struct DLManagedTensor
+  {
+    DLTensor dl_tensor;
+    void *manager_ctx;
+    void (*deleter)(struct DLManagedTensor *self);
+  } DLManagedTensor;
+}
+#endif
+
+namespace infini
+{
+  /**
+   * @brief Export the memory of 'tensor' without copying. The result holds
+   * a reference to the blob, and through it to the arena or external memory
+   * it points into, until the consumer calls its deleter. The tensor must be
+   * bound to memory already.
+   */
+  DLManagedTensor *toDLPack(const Tensor &tensor);
+
+  /**
+   * @brief Bind the memory of 'managed' to 'tensor' as an external blob,
+   * without copying, see TensorObj::setExternalBlob. This takes over
+   * 'managed': its deleter is called once no blob points into it anymore.
+   * Only dense row-major CPU tensors of the same shape and data type can be
+   * bound.
+   */
+  void bindDLPack(const Tensor &tensor, DLManagedTensor *managed);
+
+  /**
+   * @brief Add a tensor to 'graph' with the shape and data type of 'managed',
+   * bound to its memory as bindDLPack does.
+   */
+  Tensor fromDLPack(const Graph &graph, DLManagedTensor *managed);
+} // namespace infini
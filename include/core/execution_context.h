@@ -0,0 +1,55 @@
+#pragma once
+#include "core/graph.h"
+
+namespace infini
+{
+  /**
+   * @brief The activations of one run of a graph, so that several runs of it
+   * can proceed at once, one per context.
+   *
+   * A context holds clones of the operators and tensors of the graph and a
+   * private arena laid out as the graph's dataMalloc plan. Tensors bound
+   * outside the arena, such as weights loaded from a model file, are shared
+   * with the graph and only read. Weights the graph holds in its arena, such
+   * as those set by setData after dataMalloc, are copied into the private
+   * arena when the context is created. Graph inputs and outputs made
+   * external by GraphObj::setExternal are bound per context with bind.
+   *
+   * The context reflects the graph as dataMalloc left it and its weights as
+   * they are when the context is created: modifying either afterwards needs
+   * new contexts.
+   */
+  class ExecutionContextObj
+  {
+    Graph source;
+    // Clones of the operators and tensors of 'source', run in its stead.
+    Graph graph;
+    // Tensors of 'source' -> their clones, by fuid.
+    std::unordered_map<UidBaseType, Tensor> clones;
+    Ref<void> arena;
+
+  public:
+    /**
+     * @brief Create a context for 'source', which dataMalloc has planned.
+     */
+    explicit ExecutionContextObj(const Graph &source);
+    ExecutionContextObj(const ExecutionContextObj &) = delete;
+    ExecutionContextObj &operator=(const ExecutionContextObj &) = delete;
+
+    Graph getSource() const { return source; }
+    // The graph of clones that runtime.run(source, context) runs.
+    Graph getGraph() const { return graph; }
+
+    /**
+     * @brief The clone of 'tensor', a tensor of the source graph, through
+     * which this context's inputs are set and outputs read.
+     */
+    Tensor getTensor(const Tensor &tensor) const;
+
+    /**
+     * @brief Bind 'ptr' to the clone of 'tensor' for the next runs on this
+     * context, as GraphObj::bind does for the source graph.
+     */
+    void bind(const Tensor &tensor, void *ptr, Ref<void> owner = nullptr);
+  };
+} // namespace infini
@@ -8,8 +8,25 @@
 namespace infini
 {
 
+    // How dataMalloc orders the operators, see GraphObj::schedule.
+    enum class ScheduleMode
+    {
+        // The order topo_sort finds.
+        Topological,
+        // A topological order keeping the fewest bytes live at once.
+        MinPeak,
+        // A topological order running consumers right after their producers
+        // while the tensors they read are likely still in L2.
+        Locality,
+    };
+
     class GraphObj : public Object
     {
+        friend class ExecutionContextObj;
+        friend class ReplayObj;
+        friend string generateCpp(const Graph &graph, const TensorVec &inputs,
+                                  const TensorVec &outputs);
+
     protected:
         Runtime runtime;
         TensorVec tensors;
@@ -17,8 +34,15 @@ namespace infini
         Allocator allocator;
 
     public:
-        explicit GraphObj(Runtime runtime)
-            : runtime(runtime), allocator(runtime), sorted(false){};
+        explicit GraphObj(Runtime runtime,
+                          size_t alignment = Allocator::defaultAlignment)
+            : runtime(runtime), allocator(runtime, alignment), sorted(false),
+              scheduleMode(ScheduleMode::Topological){};
+        /**
+         * @brief Build a graph of clones of 'ops' and of their tensors, in
+         * the same order. The tensors have no memory.
+         */
+        GraphObj(Runtime runtime, const OpVec &ops);
         string toString() const override;
         Runtime getRuntime() const { return runtime; }
 
@@ -39,6 +63,17 @@ namespace infini
                 tensors.erase(it);
         }
 
+        // Placement policy used by dataMalloc, first fit by default.
+        void setAllocStrategy(Ref<AllocStrategy> strategy)
+        {
+            allocator.setStrategy(strategy);
+        }
+
+        // Record the allocations of the next dataMalloc, tagged with the
+        // guid of the operator each step runs, see AllocTrace.
+        void recordAllocTrace() { allocator.startTrace(); }
+        Ref<AllocTrace> getAllocTrace() const { return allocator.getTrace(); }
+
         const TensorVec &getTensors() const { return tensors; }
         const OpVec &getOperators() const { return ops; }
         Tensor getTensor(int) const;
@@ -53,9 +88,58 @@ namespace infini
 
         void optimize();
 
+        // Topological by default, the others are opt-in.
+        void setScheduleMode(ScheduleMode mode) { scheduleMode = mode; }
+
+        /**
+         * @brief Reorder the sorted operators per the schedule mode. With
+         * MinPeak, graphs of up to exactScheduleLimit operators are searched
+         * exhaustively and larger ones greedily run the ready operator which
+         * adds the fewest bytes. With Locality, the ready operator reading
+         * the most bytes a simulated L2 still holds runs first.
+         * dataMalloc calls it before planning.
+         */
+        void schedule();
+
+        static constexpr size_t exactScheduleLimit = 16;
+
         void shape_infer();
 
-        void dataMalloc();
+        /**
+         * @brief Plan the memory of all tensors and bind them to it. If
+         * 'budget' is not 0, cheap operators are first recomputed to bring
+         * the peak down to it, see rematerialize.
+         */
+        void dataMalloc(size_t budget = 0);
+
+        /**
+         * @brief Keep 'tensor', an input or output of the graph, out of the
+         * arena: its memory is bound by the caller with bind before each
+         * run. Call it before dataMalloc.
+         */
+        void setExternal(const Tensor &tensor);
+
+        /**
+         * @brief Bind 'ptr' to an external tensor, see setExternal, so that
+         * kernels read or write it in place. After dataMalloc, the tensors
+         * placed in it, such as a Reshape of an input or the inputs of a
+         * Concat producing an output, follow it. It may be called again
+         * between runs. 'owner' keeps the memory alive while it is bound.
+         */
+        void bind(const Tensor &tensor, void *ptr, Ref<void> owner = nullptr);
+
+        /**
+         * @brief Copy cheap operators (Relu, Transpose, Cast, Clip and
+         * element-wise ones) right before the late readers of their output,
+         * so the output is not kept alive in between, until the most bytes
+         * live at once fit in 'budget', no copy lowers them further or
+         * maxRematerializeRounds copies were made. The extra FLOPs and the
+         * bytes saved are printed.
+         * @return The most bytes live at once afterwards.
+         */
+        size_t rematerialize(size_t budget);
+
+        static constexpr size_t maxRematerializeRounds = 256;
 
         /**
          * @brief Add an operator and create its outputs. Output tensor arguments
@@ -104,6 +188,13 @@ namespace infini
             return ret;
         }
 
+        /**
+         * @brief Replace 'ops', sorted, by 'op', which reads their inputs
+         * and writes the output of the last of them. The other outputs of
+         * 'ops' must be read by 'ops' alone, they are removed.
+         */
+        void replaceOperators(const OpVec &ops, const Operator &op);
+
         bool checkValid() const;
 
     private:
@@ -112,10 +203,33 @@ namespace infini
          */
         void addOperatorAndConnect(const Operator &op);
 
+        /**
+         * @brief Insert a copy of the source of 'tensor' at 'pos' in the
+         * sorted operators, and make 'consumers' read its output instead.
+         */
+        Operator recompute(const Tensor &tensor, const OpVec &consumers,
+                           size_t pos);
+        void undoRecompute(const Operator &copy, const Tensor &tensor,
+                           const OpVec &consumers);
+
         /**
          * @brief If the nodes is sorted in topological order.
          */
         bool sorted;
+
+        ScheduleMode scheduleMode;
+
+        // Whether dataMalloc has run.
+        bool allocated = false;
+
+        // Tensors placed in the arena -> their byte offset in it. Filled by
+        // dataMalloc, see ExecutionContextObj.
+        std::unordered_map<TensorObj *, size_t> arenaOffset;
+
+        // External roots -> the other tensors dataMalloc placed in them,
+        // with their byte offsets. Filled by dataMalloc, see bind.
+        std::unordered_map<TensorObj *, vector<std::pair<Tensor, size_t>>>
+            placedIn;
     };
 
 } // namespace infini
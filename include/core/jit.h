@@ -0,0 +1,37 @@
+#pragma once
+#include "core/graph.h"
+
+namespace infini
+{
+  // The directory in $INFINITENSOR_JIT_CACHE, else infinitensor-jit in the
+  // user's cache directory ($XDG_CACHE_HOME or ~/.cache), else
+  // /tmp/infinitensor-jit-<uid>.
+  string defaultJitCacheDir();
+
+  struct JitOptions
+  {
+    // Compiled regions are kept here, named by a hash of their source, of
+    // the compiler and flags and of the host CPU, and loaded again by later
+    // processes. The directory is created for the current user only, and
+    // refused if another user owns it.
+    string cacheDir = defaultJitCacheDir();
+    string compiler = "c++";
+    string flags = "-O3 -march=native";
+  };
+
+  /**
+   * @brief Replace regions of element-wise operators, Relu and Clip by
+   * FusedElementWiseObj operators computed in one pass. Call it before
+   * dataMalloc, after optimize.
+   *
+   * A region grows from an operator through the inputs produced by other
+   * region operators and read by nothing else, so its intermediate tensors
+   * are never stored. Its inputs may broadcast and be strided views. Each
+   * region of two or more operators is emitted as C++ loops with its shapes,
+   * strides and constants baked in, compiled with 'options' unless the cache
+   * has it already, and loaded with dlopen.
+   *
+   * @return The number of regions fused.
+   */
+  size_t fuseElementWise(const Graph &graph, const JitOptions &options = {});
+} // namespace infini
@@ -10,6 +10,17 @@ namespace infini
 
     class RuntimeObj;
 
+    /**
+     * @brief A kernel invocation with its types, pointers and sizes resolved,
+     * see Kernel::capture. Replaying it calls 'fn' on 'args' and nothing
+     * else.
+     */
+    struct Launch
+    {
+        void (*fn)(const void *args) = nullptr;
+        std::shared_ptr<const void> args;
+    };
+
     class Kernel
     {
     public:
@@ -21,6 +32,28 @@ namespace infini
          */
         virtual void compute(const Operator &op,
                              const RuntimeObj *context) const = 0;
+
+        /**
+         * @brief Resolve the invocation of 'op' on the memory its tensors are
+         * bound to now, for ReplayObj. An empty launch means there is nothing
+         * to do. Kernels without a resolved form replay through compute.
+         */
+        virtual Launch capture(const Operator &op,
+                               const RuntimeObj *context) const
+        {
+            struct Args
+            {
+                const Kernel *kernel;
+                Operator op;
+                const RuntimeObj *context;
+            };
+            return {[](const void *args)
+                    {
+                        auto a = static_cast<const Args *>(args);
+                        a->kernel->compute(a->op, a->context);
+                    },
+                    std::make_shared<Args>(Args{this, op, context})};
+        }
     };
 
     class KernelRegistry
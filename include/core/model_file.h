@@ -0,0 +1,34 @@
+#pragma once
+#include "core/graph.h"
+
+namespace infini
+{
+  /**
+   * @brief Save the tensors and operators of 'graph' to 'path', with the data
+   * of 'weights'. Views set up by optimize() are not saved.
+   *
+   * The file is a header, the tensor and operator records, then the data of
+   * every weight at a 64-byte aligned offset:
+   *
+   *   header:   "ITMODEL\0", u32 version, u32 #tensors, u32 #operators
+   *   tensor:   u32 dtype, u32 rank, i32 dims[rank], u64 data offset or 0
+   *   operator: u32 type, u32 #inputs, u32 #outputs, u32 tensors[],
+   *             u32 #ints, i64 ints[], u32 #floats, f32 floats[]
+   *
+   * All values are little-endian and tensors are referred to by index.
+   * Weights are mapped without conversion, so big-endian hosts are not
+   * supported: the library does not build for them.
+   */
+  void saveModel(const Graph &graph, const string &path,
+                 const TensorVec &weights);
+
+  /**
+   * @brief Load a model saved by saveModel into a new graph on 'runtime'.
+   *
+   * The file is mapped privately: weight tensors point straight into the
+   * mapping, pages are read on first use and shared through the page cache
+   * with every process loading the same file. Weights are bound already, so
+   * dataMalloc leaves them out of the arena.
+   */
+  Graph loadModel(const string &path, Runtime runtime);
+} // namespace infini
@@ -0,0 +1,37 @@
+#pragma once
+#include "core/graph.h"
+
+namespace infini
+{
+  /**
+   * @brief A graph imported from an ONNX model, with its inputs and outputs in
+   * the order the model declares them.
+   */
+  struct OnnxModel
+  {
+    Graph graph;
+    TensorVec inputs, outputs;
+  };
+
+  /**
+   * @brief List the operator types of the ONNX model at 'path' that have no
+   * counterpart here, each once, without importing anything.
+   */
+  vector<string> unsupportedOnnxOperators(const string &path);
+
+  /**
+   * @brief Import the ONNX model at 'path' into a new graph on 'runtime'.
+   *
+   * The file is mapped and parsed in place. Unsupported operators are
+   * reported before any weight is read. The weights are then laid out in one
+   * arena, 64-byte aligned, and every initializer is decoded straight from
+   * the mapping into its slot, so no message is materialized and the pages
+   * of the file are dropped once read. Weights are bound already, so
+   * dataMalloc leaves them out of its arena.
+   *
+   * Initializers and Constant nodes feeding shape-like inputs (Reshape shape,
+   * Squeeze and Unsqueeze axes, Clip bounds) become attributes. Graph inputs
+   * must have static shapes.
+   */
+  OnnxModel importOnnx(const string &path, Runtime runtime);
+} // namespace infini
@@ -24,6 +24,11 @@ namespace infini
             Relu,
             Sub,
             Transpose,
+            Flatten,
+            Reshape,
+            Squeeze,
+            Unsqueeze,
+            FusedElementWise,
 
         } type;
 
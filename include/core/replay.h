@@ -0,0 +1,46 @@
+#pragma once
+#include "core/graph.h"
+#include "core/kernel.h"
+
+namespace infini
+{
+  /**
+   * @brief A run of a fixed-shape graph frozen into the list of its kernel
+   * invocations, for graphs that run many times unchanged.
+   *
+   * Capturing runs the graph once through Kernel::capture, resolving every
+   * operator's kernel, data type, pointers and sizes. Kernels with a
+   * resolved form also precompute their strided and broadcast indexing.
+   * run then calls the recorded launches in order, with no graph traversal,
+   * kernel lookup, virtual dispatch or checks.
+   *
+   * The launches point to the memory the tensors are bound to at capture:
+   * write inputs into and read outputs from those tensors. Rebinding them,
+   * e.g. with GraphObj::bind, or running dataMalloc again needs a new
+   * capture. To replay on private activations, capture the graph of an
+   * ExecutionContextObj.
+   */
+  class ReplayObj
+  {
+    // Keeps the memory and the operators the launches refer to alive.
+    Graph graph;
+    vector<Launch> launches;
+
+  public:
+    explicit ReplayObj(const Graph &graph);
+    ReplayObj(const ReplayObj &) = delete;
+    ReplayObj &operator=(const ReplayObj &) = delete;
+
+    void run() const
+    {
+      for (const auto &launch : launches)
+        launch.fn(launch.args.get());
+    }
+
+    Graph getGraph() const { return graph; }
+    // Launches recorded, operators with nothing to do are left out.
+    size_t size() const { return launches.size(); }
+  };
+
+  using Replay = Ref<ReplayObj>;
+} // namespace infini
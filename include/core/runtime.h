@@ -2,6 +2,11 @@
 #include "core/common.h"
 #include "core/op_type.h"
 #include "core/ref.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <sched.h>
+#include <thread>
 
 namespace infini
 {
@@ -10,12 +15,14 @@ namespace infini
   class GraphObj;
   class RuntimeObj;
   class BlobObj;
+  class ExecutionContextObj;
 
   using Tensor = Ref<TensorObj>;
   using Operator = Ref<OperatorObj>;
   using Graph = Ref<GraphObj>;
   using Runtime = Ref<RuntimeObj>;
   using Blob = Ref<BlobObj>;
+  using ExecutionContext = Ref<ExecutionContextObj>;
 
   using TensorVec = vector<Tensor>;
   using OpVec = vector<Operator>;
@@ -25,6 +32,23 @@ namespace infini
     CPU = 1
   };
 
+  // How the memory of a new arena is prepared before its first use.
+  enum class ArenaInit
+  {
+    // Zero-filled, as calloc does. Pages of large arenas are faulted in
+    // lazily by whichever thread touches them first.
+    Zero,
+    // Large arenas are faulted in up front by all OpenMP threads with a
+    // static partitioning, so the first run takes no page faults and the
+    // pages are spread over the nodes of the threads, which the element-wise,
+    // unary and transpose kernels split the same static way. Small arenas
+    // are not zeroed.
+    FirstTouch,
+    // Nothing is done: small arenas are not zeroed and large ones are
+    // faulted in lazily.
+    Uninitialized
+  };
+
   class RuntimeObj : public std::enable_shared_from_this<RuntimeObj>
   {
   protected:
@@ -37,7 +61,12 @@ namespace infini
     RuntimeObj &operator=(RuntimeObj const &) = delete;
     virtual ~RuntimeObj() {}
 
-    virtual void run(const Graph &graph) const = 0;
+    // profiling: time every operator and print the totals per operator type
+    virtual void run(const Graph &graph, bool profiling = false) const = 0;
+    // Runs 'graph' on the activations of 'context', see ExecutionContextObj.
+    // Runs on distinct contexts may overlap.
+    void run(const Graph &graph, const ExecutionContext &context,
+             bool profiling = false) const;
     virtual void *alloc(size_t size) = 0;
     virtual void dealloc(void *ptr) = 0;
 
@@ -46,11 +75,33 @@ namespace infini
       return true;
     }
 
+    // Kernels process large operands in tiles of this many bytes, or all at
+    // once if it is 0.
+    virtual size_t getTileBytes() const { return 0; }
+    // Hints that [ptr, ptr + bytes) is about to be accessed.
+    virtual void prefetch(const void *ptr, size_t bytes) const {}
+
     virtual string toString() const = 0;
+
+  protected:
+    void printProfilingData(double totalTime,
+                            const std::map<OpType, double> &opTime,
+                            const std::map<OpType, int> &opCnt) const;
   };
 
   class NativeCpuRuntimeObj : public RuntimeObj
   {
+    // Arenas of at least one huge page are mapped directly, aligned to the
+    // huge page size and advised to be backed by transparent huge pages.
+    static constexpr size_t hugePageSize = 2 << 20;
+    // Smaller arenas are aligned to the cache line.
+    static constexpr size_t alignment = 64;
+
+    std::mutex mappingsLock;
+    // Arenas allocated by mmap, and their mapped length.
+    std::unordered_map<void *, size_t> mappings;
+    ArenaInit arenaInit = ArenaInit::Zero;
+
   public:
     NativeCpuRuntimeObj() : RuntimeObj(Device::CPU) {}
 
@@ -61,9 +112,106 @@ namespace infini
       return instance;
     }
     void dealloc(void *ptr) override;
-    void run(const Graph &graph) const override;
+    using RuntimeObj::run;
+    void run(const Graph &graph, bool profiling = false) const override;
+    // Only affects arenas allocated afterwards.
+    void setArenaInit(ArenaInit mode) { arenaInit = mode; }
+    ArenaInit getArenaInit() const { return arenaInit; }
     void *alloc(size_t size) override;
     string toString() const override;
+
+  protected:
+    // Maps an anonymous arena of at least 'size' bytes starting on a huge
+    // page boundary, records it for dealloc and sets its mapped 'length'.
+    char *mapArena(size_t size, size_t &length);
+    // Faults the pages of a mapped arena in according to 'arenaInit'.
+    void touchArena(char *ptr, size_t length) const;
+    // Makes dealloc unmap 'length' bytes at 'ptr' instead of freeing it.
+    void recordMapping(void *ptr, size_t length);
+  };
+
+  /**
+   * @brief A CPU runtime bound to one NUMA node. Its arenas are allocated on
+   * the node and the threads running a graph are pinned to the node's cores.
+   * Graphs are bound to a node by creating them with its runtime, so one
+   * graph replica per socket works on local memory only.
+   */
+  class NumaCpuRuntimeObj : public NativeCpuRuntimeObj
+  {
+    int node;
+    vector<int> cpus;
+
+  public:
+    explicit NumaCpuRuntimeObj(int node);
+
+    static Ref<NumaCpuRuntimeObj> &getInstance(int node);
+    // The online NUMA nodes, {0} if the system does not expose them.
+    static vector<int> getNodes();
+
+    using RuntimeObj::run;
+    void run(const Graph &graph, bool profiling = false) const override;
+    void *alloc(size_t size) override;
+    string toString() const override;
+    int getNode() const { return node; }
+    const vector<int> &getCpus() const { return cpus; }
+
+  private:
+    // Restricts the calling thread to the node's cores and pins each OpenMP
+    // worker of its team to one of them. The previous mask of each thread is
+    // saved in 'masks', indexed by OpenMP thread number.
+    void bindThreads(vector<cpu_set_t> &masks) const;
+    // Gives the threads bound by bindThreads their 'masks' back.
+    void unbindThreads(const vector<cpu_set_t> &masks) const;
+  };
+
+  /**
+   * @brief A CPU runtime whose arenas are mapped from unlinked files in
+   * 'directory', so graphs whose working set exceeds physical memory still
+   * run: the kernel writes arena pages back to the file and reads them in
+   * again on demand. Kernels walk large operands tile by tile, and a
+   * prefetch thread reads the next tile in while the current one computes.
+   */
+  class OutOfCoreCpuRuntimeObj : public NativeCpuRuntimeObj
+  {
+    string directory;
+    size_t tileBytes;
+
+    // Ranges waiting for the prefetch thread, oldest first.
+    mutable std::mutex queueLock;
+    mutable std::condition_variable queueCond;
+    mutable std::deque<std::pair<const char *, size_t>> queue;
+    // The arenas mapped by alloc and their length. Only ranges inside them
+    // are prefetched: other memory, such as external blobs, may be unmapped
+    // by its owner at any time.
+    std::map<const char *, size_t> arenas;
+    // Whether the prefetch thread is reading a range, which dealloc waits on.
+    bool busy = false;
+    bool stopping = false;
+    std::thread prefetcher;
+
+  public:
+    static constexpr size_t defaultTileBytes = 8 << 20;
+    // Older ranges are dropped beyond this many, they are stale anyway.
+    static constexpr size_t maxQueuedRanges = 16;
+
+    // An empty 'directory' means defaultDirectory().
+    explicit OutOfCoreCpuRuntimeObj(string directory = "",
+                                    size_t tileBytes = defaultTileBytes);
+    ~OutOfCoreCpuRuntimeObj();
+
+    // $TMPDIR if set, otherwise /var/tmp. Not /tmp, which is often a tmpfs
+    // held in the very memory the arenas are meant to spill out of.
+    static string defaultDirectory();
+
+    void *alloc(size_t size) override;
+    void dealloc(void *ptr) override;
+    size_t getTileBytes() const override { return tileBytes; }
+    void prefetch(const void *ptr, size_t bytes) const override;
+    string toString() const override;
+
+  private:
+    // Body of the prefetch thread.
+    void prefetchLoop();
   };
 
 } // namespace infini
@@ -30,6 +30,10 @@ namespace infini
         size_t _size; // Cache of Π(shape).
         Fuid fuid;    // Cloned tensors share the same id. Tensors constructed from
                       // scratch have a new id.
+        Shape stride; // Element stride of each dimension, row-major by default.
+        size_t offset; // Element offset of the first element in the blob.
+        bool view;    // Whether it aliases the memory of its source's input.
+        bool external; // Whether its blob is bound by the user, see setExternalBlob.
 
     public:
         TensorObj(Shape shape, DataType dtype, Runtime runtime);
@@ -42,12 +46,47 @@ namespace infini
         Shape getDims() const { return shape; }
         void setShape(Shape shape_);
         size_t getRank() const { return shape.size(); }
+        Shape getStride() const { return stride; }
+        size_t getOffset() const { return offset; }
+        /**
+         * @brief Whether the elements are laid out densely in row-major order.
+         */
+        bool isContiguous() const;
+        bool isView() const { return view; }
+        /**
+         * @brief Turn this tensor into a strided view on the memory of the
+         * first input of its source operator. No data is moved: dataMalloc
+         * binds it to the same blob and kernels read it through the strides.
+         * A stride of 0 broadcasts the dimension.
+         */
+        void setView(Shape stride_, size_t offset_);
         UidBaseType getFuid() const { return fuid; }
 
         void setData(
             std::function<void(void *, size_t, DataType)> const &generator) const;
 
         void setDataBlob(const Blob &blob);
+        /**
+         * @brief Bind memory owned outside the graph, such as a weight mapped
+         * from a model file. GraphObj::dataMalloc leaves the tensor out of
+         * the arena and keeps this binding.
+         */
+        void setExternalBlob(const Blob &blob);
+        bool isExternal() const { return external; }
+        Blob getDataBlob() const { return data; }
+
+        /**
+         * @brief A copy with the same fuid, shape, layout and external flag,
+         * but no memory and no connection to any operator.
+         */
+        Tensor clone() const
+        {
+            auto obj = make_ref<TensorObj>(*this);
+            obj->data = nullptr;
+            obj->targets.clear();
+            obj->source.reset();
+            return obj;
+        }
 
         void printData() const;
         bool equalData(const Tensor &rhs, double relativeError = 1e-6) const;
@@ -66,7 +105,8 @@ namespace infini
             static_assert(std::is_pointer_v<T>,
                           "Raw data pointer has a type of pointer");
             IT_ASSERT(data != nullptr);
-            return data->getPtr<T>();
+            return reinterpret_cast<T>(data->getPtr<char *>() +
+                                       offset * dtype.getSize());
         }
 
         DataType getDType() const { return dtype; }
@@ -84,7 +124,7 @@ namespace infini
 
             auto numDims = shape.size();
             auto dimSzVec = vector<int>(numDims, 1);
-            auto ptr = data->getPtr<T *>();
+            auto ptr = getRawDataPtr<T *>();
             dimSzVec[numDims - 1] = shape[numDims - 1];
 
             for (int i = numDims - 1; i != 0; --i)
@@ -0,0 +1,43 @@
+#pragma once
+#include "core/operator.h"
+
+namespace infini
+{
+  /**
+   * @brief A region of element-wise operators, Relu and Clip computed in one
+   * pass by a function compiled for its shapes, strides and constants, see
+   * fuseElementWise.
+   */
+  class FusedElementWiseObj : public OperatorObj
+  {
+  public:
+    // Reads the inputs, in order, and writes the output, all bound.
+    using Function = void (*)(const void *const *inputs, void *output);
+
+    /**
+     * @brief Construct a new FusedElementWise object.
+     *
+     * @param graph The computation graph that this operator belongs to.
+     * @param inputs The inputs of the region.
+     * @param output The output of the region.
+     * @param description The fused operator types, for toString.
+     * @param function The compiled region.
+     * @param library Keeps the shared object of 'function' loaded.
+     */
+    FusedElementWiseObj(GraphObj *graph, TensorVec inputs, Tensor output,
+                        string description, Function function,
+                        Ref<void> library);
+    OP_CLONE(FusedElementWiseObj);
+    optional<vector<Shape>> inferShape(const TensorVec &inputs) override;
+
+    std::string toString() const override;
+    int numInputs() const override { return inputs.size(); }
+    int numOutputs() const override { return 1; }
+    Function getFunction() const { return function; }
+
+  private:
+    string description;
+    Function function;
+    Ref<void> library;
+  };
+}; // namespace infini
@@ -0,0 +1,122 @@
+#pragma once
+#include "core/operator.h"
+
+namespace infini
+{
+  /**
+   * @brief Change the shape of the input tensor without touching its data.
+   * The output shares the memory of the input, see GraphObj::dataMalloc.
+   *
+   */
+  class ReshapeObj : public OperatorObj
+  {
+  public:
+    /**
+     * @brief Construct a new Reshape object.
+     *
+     * @param graph The computation graph that this operator belongs to.
+     * @param input The input tensor.
+     * @param output The output tensor.
+     * @param dims The target shape. As in ONNX, 0 copies the corresponding
+     * input dimension and at most one -1 is inferred from the remaining size.
+     */
+    ReshapeObj(GraphObj *graph, Tensor input, Tensor output, Shape dims);
+    OP_CLONE(ReshapeObj);
+    optional<vector<Shape>> inferShape(const TensorVec &inputs) override;
+
+    std::string toString() const override;
+    int numInputs() const override { return 1; }
+    int numOutputs() const override { return 1; }
+    Shape getShape() const { return dims; }
+
+  private:
+    Shape dims;
+  };
+
+  /**
+   * @brief Flatten the input tensor into a 2D matrix. Dimensions before `axis`
+   * form the first output dimension and the rest form the second one.
+   *
+   */
+  class FlattenObj : public OperatorObj
+  {
+  public:
+    /**
+     * @brief Construct a new Flatten object.
+     *
+     * @param graph The computation graph that this operator belongs to.
+     * @param input The input tensor.
+     * @param output The output tensor.
+     * @param axis The split point, in the range [-rank, rank].
+     */
+    FlattenObj(GraphObj *graph, Tensor input, Tensor output, int axis);
+    OP_CLONE(FlattenObj);
+    optional<vector<Shape>> inferShape(const TensorVec &inputs) override;
+
+    std::string toString() const override;
+    int numInputs() const override { return 1; }
+    int numOutputs() const override { return 1; }
+    int getAxis() const { return axis; }
+
+  private:
+    int axis;
+  };
+
+  /**
+   * @brief Remove single-dimensional entries from the shape of the input.
+   *
+   */
+  class SqueezeObj : public OperatorObj
+  {
+  public:
+    /**
+     * @brief Construct a new Squeeze object.
+     *
+     * @param graph The computation graph that this operator belongs to.
+     * @param input The input tensor.
+     * @param output The output tensor.
+     * @param axes The dimensions to remove. All dimensions of size 1 are
+     * removed if it is empty.
+     */
+    SqueezeObj(GraphObj *graph, Tensor input, Tensor output, vector<int> axes);
+    OP_CLONE(SqueezeObj);
+    optional<vector<Shape>> inferShape(const TensorVec &inputs) override;
+
+    std::string toString() const override;
+    int numInputs() const override { return 1; }
+    int numOutputs() const override { return 1; }
+    vector<int> getAxes() const { return axes; }
+
+  private:
+    vector<int> axes;
+  };
+
+  /**
+   * @brief Insert single-dimensional entries into the shape of the input.
+   *
+   */
+  class UnsqueezeObj : public OperatorObj
+  {
+  public:
+    /**
+     * @brief Construct a new Unsqueeze object.
+     *
+     * @param graph The computation graph that this operator belongs to.
+     * @param input The input tensor.
+     * @param output The output tensor.
+     * @param axes The positions of the inserted dimensions in the output.
+     */
+    UnsqueezeObj(GraphObj *graph, Tensor input, Tensor output,
+                 vector<int> axes);
+    OP_CLONE(UnsqueezeObj);
+    optional<vector<Shape>> inferShape(const TensorVec &inputs) override;
+
+    std::string toString() const override;
+    int numInputs() const override { return 1; }
+    int numOutputs() const override { return 1; }
+    vector<int> getAxes() const { return axes; }
+
+  private:
+    vector<int> axes;
+  };
+} // namespace infini
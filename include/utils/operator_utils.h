@@ -18,6 +18,8 @@ Shape locate_index(size_t inputN, const Shape &shape);
 // Delocate the ShapeIndex from Shape with broadcast
 size_t delocate_index(const Shape &shapeIndex, const Shape &shape,
                       const Shape &stride);
+// Get the row-major stride of a dense tensor with the given shape
+Shape get_contiguous_stride(const Shape &shape);
 // Convert KernelAttrs to a string representation
 std::string get_kernel_attrs_str(const KernelAttrs &kernelAttrs);
 
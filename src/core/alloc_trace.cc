@@ -0,0 +1,109 @@
+#include "core/alloc_trace.h"
+#include "core/allocator.h"
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace infini
+{
+    namespace
+    {
+        constexpr char magic[4] = {'I', 'T', 'A', 'T'};
+
+        void putVarint(string &buf, uint64_t value)
+        {
+            while (value >= 0x80)
+            {
+                buf.push_back(char(value | 0x80));
+                value >>= 7;
+            }
+            buf.push_back(char(value));
+        }
+
+        uint64_t getVarint(const string &buf, size_t &pos)
+        {
+            uint64_t value = 0;
+            for (int shift = 0;; shift += 7)
+            {
+                IT_ASSERT(pos < buf.size() && shift < 64, "Truncated trace");
+                uint8_t byte = buf[pos++];
+                value |= uint64_t(byte & 0x7f) << shift;
+                if (!(byte & 0x80))
+                    return value;
+            }
+        }
+    } // namespace
+
+    void AllocTrace::addAlloc(uint64_t id, uint64_t size, uint64_t tag)
+    {
+        events.push_back({false, id, size, tag});
+    }
+
+    void AllocTrace::addFree(uint64_t id, uint64_t tag)
+    {
+        events.push_back({true, id, 0, tag});
+    }
+
+    void AllocTrace::save(const string &path) const
+    {
+        string buf(magic, sizeof(magic));
+        putVarint(buf, version);
+        putVarint(buf, alignment);
+        putVarint(buf, events.size());
+        for (const auto &event : events)
+        {
+            putVarint(buf, event.id << 1 | event.isFree);
+            if (!event.isFree)
+                putVarint(buf, event.size);
+            putVarint(buf, event.tag);
+        }
+        std::ofstream file(path, std::ios::binary);
+        IT_ASSERT(file.good(), "Cannot open " + path);
+        file.write(buf.data(), buf.size());
+        IT_ASSERT(file.good(), "Cannot write " + path);
+    }
+
+    AllocTrace AllocTrace::load(const string &path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        IT_ASSERT(file.good(), "Cannot open " + path);
+        string buf((std::istreambuf_iterator<char>(file)),
+                   std::istreambuf_iterator<char>());
+        IT_ASSERT(buf.size() >= sizeof(magic) &&
+                      std::memcmp(buf.data(), magic, sizeof(magic)) == 0,
+                  path + " is not an allocation trace");
+        size_t pos = sizeof(magic);
+        uint64_t fileVersion = getVarint(buf, pos);
+        IT_ASSERT(fileVersion == version, "Unsupported trace version");
+        AllocTrace trace(getVarint(buf, pos));
+        size_t count = getVarint(buf, pos);
+        trace.events.reserve(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            uint64_t head = getVarint(buf, pos);
+            bool isFree = head & 1;
+            uint64_t size = isFree ? 0 : getVarint(buf, pos);
+            trace.events.push_back({isFree, head >> 1, size, getVarint(buf, pos)});
+        }
+        return trace;
+    }
+
+    size_t AllocTrace::replay(Allocator &allocator) const
+    {
+        // block id -> (offset, size)
+        std::unordered_map<uint64_t, std::pair<size_t, size_t>> blocks;
+        for (const auto &event : events)
+        {
+            if (!event.isFree)
+            {
+                blocks[event.id] = {allocator.alloc(event.size), event.size};
+                continue;
+            }
+            auto it = blocks.find(event.id);
+            IT_ASSERT(it != blocks.end(), "Free of an unknown block");
+            allocator.free(it->second.first, it->second.second);
+            blocks.erase(it);
+        }
+        return allocator.getPeak();
+    }
+} // namespace infini
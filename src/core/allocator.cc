@@ -2,68 +2,85 @@
 #include <utility>
 #include <list>
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 namespace infini
 {
     
-    Allocator::Allocator(Runtime runtime) : runtime(runtime)
+    Allocator::Allocator(Runtime runtime, size_t alignment)
+        : runtime(runtime), alignment(alignment),
+          strategy(make_ref<FirstFitStrategy>())
     {
         used = 0;
         peak = 0;
         ptr = nullptr;
+        live = 0;
+        maxLive = 0;
+        traceTag = 0;
+        nextTraceId = 0;
 
-        // 'alignment' defaults to sizeof(uint64_t), because it is the length of
-        // the longest data type currently supported by the DataType field of
-        // the tensor
-        alignment = sizeof(uint64_t);
-        
+        // 'alignment' has to cover sizeof(uint64_t), the length of the longest
+        // data type currently supported by the DataType field of the tensor
+        IT_ASSERT(alignment >= sizeof(uint64_t) &&
+                  (alignment & (alignment - 1)) == 0);
     }
 
-    Allocator::~Allocator()
+    Allocator::~Allocator() {}
+
+    size_t Allocator::alloc(size_t size)
     {
-        if (this->ptr != nullptr)
+        IT_ASSERT(this->ptr == nullptr);
+        size_t start = allocBlock(size);
+        if (trace)
         {
-            runtime->dealloc(this->ptr);
+            traceIds[start] = nextTraceId;
+            trace->addAlloc(nextTraceId++, size, traceTag);
         }
+        return start;
     }
 
-    size_t Allocator::alloc(size_t size)
+    size_t Allocator::allocBlock(size_t size)
     {
-        IT_ASSERT(this->ptr == nullptr);
         // pad the size to the multiple of alignment
         size = this->getAlignedSize(size);
+        live += size;
+        maxLive = std::max(maxLive, live);
+        size = strategy->roundSize(size);
         // 对齐大小
         // =================================== 作业 ===================================
         // TODO: 设计一个算法来分配内存，返回起始地址偏移量
         // =================================== 作业 ===================================
 
 
-        // first fit
-        // 从可用内存块的开始位置顺序查找，找到第一个满足需求的内存块。
+        // 在空闲块中查找满足需求的内存块，按 policy 选择。
         // 分配该内存块，如果有剩余空间，则将剩余部分标记为新的可用块。
-        auto it = freeBlockMap.begin();
-        for (; it != freeBlockMap.end(); ++it) {
-            if (it->second >= size) {
-                size_t start = it->first;
-
-                used += size;
-                peak = std::max(used, peak);
-
-                size_t remain = it->second - size;
-                if (remain > 0) {
-                    freeBlockMap[start + size] = remain;
-                }
-
-                freeBlockMap.erase(it);
-
-                return start;
+        if (auto addr = strategy->find(freeBlocks, size)) {
+            auto it = freeBlocks.byAddr.find(*addr);
+            IT_ASSERT(it != freeBlocks.byAddr.end() && it->second >= size);
+            size_t start = it->first;
+            size_t remain = it->second - size;
+            if (remain > 0) {
+                moveFreeBlock(it, start + size, remain);
+            } else {
+                eraseFreeBlock(it);
             }
+            used += size;
+            return start;
         }
 
-        // 如果没有找到，重新分配内存
-        size_t new_start = used;
+        // 如果没有找到，扩展内存末尾；若末尾恰好是空闲块，则与之合并
+        // The arena ends at 'peak', not at 'used': freed blocks below the end
+        // do not make room there.
+        size_t new_start = peak;
+        if (!freeBlocks.byAddr.empty()) {
+            auto last = std::prev(freeBlocks.byAddr.end());
+            if (last->first + last->second == peak) {
+                new_start = last->first;
+                eraseFreeBlock(last);
+            }
+        }
         used += size;
-        peak = std::max(peak, used);
+        peak = std::max(peak, new_start + size);
 
         return new_start;
 
@@ -72,7 +89,16 @@ namespace infini
     void Allocator::free(size_t addr, size_t size)
     {
         IT_ASSERT(this->ptr == nullptr);
+        if (trace)
+        {
+            auto it = traceIds.find(addr);
+            IT_ASSERT(it != traceIds.end());
+            trace->addFree(it->second, traceTag);
+            traceIds.erase(it);
+        }
         size = getAlignedSize(size);
+        live -= size;
+        size = strategy->roundSize(size);
 
         // =================================== 作业 ===================================
         // TODO: 设计一个算法来回收内存
@@ -80,39 +106,94 @@ namespace infini
     
         used -= size;
 
-        // 将回收的内存块插入到 freeBlockMap 中
-        freeBlockMap[addr] = size;
-
-        // 合并相邻的空闲内存块
-        auto it = freeBlockMap.find(addr);
-        if (it != freeBlockMap.end()) {
-            auto prev_it = it;
-            if (prev_it != freeBlockMap.begin()) {
-                --prev_it;
-                if (prev_it->first + prev_it->second == addr) {
-                    prev_it->second += size;
-                    freeBlockMap.erase(it);
-                    it = prev_it;
-                }
+        // 合并相邻的空闲内存块，再将回收的内存块插入到 freeBlocks 中
+        // 合并后的块沿用相邻块的位置，只在无法合并时插入新块
+        auto next_it = freeBlocks.byAddr.lower_bound(addr);
+        auto merged = freeBlocks.byAddr.end();
+        if (next_it != freeBlocks.byAddr.begin()) {
+            auto prev_it = std::prev(next_it);
+            if (prev_it->first + prev_it->second == addr) {
+                addr = prev_it->first;
+                size += prev_it->second;
+                merged = prev_it;
             }
-
-            auto next_it = it;
-            ++next_it;
-            if (next_it != freeBlockMap.end() && addr + size == next_it->first) {
-                it->second += next_it->second;
-                freeBlockMap.erase(next_it);
+        }
+        if (next_it != freeBlocks.byAddr.end() && addr + size == next_it->first) {
+            size += next_it->second;
+            if (merged == freeBlocks.byAddr.end()) {
+                merged = next_it;
+            } else {
+                eraseFreeBlock(next_it);
             }
         }
-        
-        
+        if (merged == freeBlocks.byAddr.end()) {
+            insertFreeBlock(addr, size);
+        } else {
+            moveFreeBlock(merged, addr, size);
+        }
+    }
+
+    void Allocator::insertFreeBlock(size_t addr, size_t size)
+    {
+        freeBlocks.byAddr[addr] = size;
+        freeBlocks.bySize.emplace(size, addr);
+        freeBlocks.tree.insert(addr, size);
+    }
+
+    void Allocator::moveFreeBlock(std::map<size_t, size_t>::iterator it,
+                                  size_t addr, size_t size)
+    {
+        freeBlocks.bySize.erase({it->second, it->first});
+        freeBlocks.bySize.emplace(size, addr);
+        freeBlocks.tree.move(it->first, addr, size);
+        if (it->first == addr) {
+            it->second = size;
+        } else {
+            auto hint = freeBlocks.byAddr.erase(it);
+            freeBlocks.byAddr.emplace_hint(hint, addr, size);
         }
+    }
+
+    void Allocator::eraseFreeBlock(std::map<size_t, size_t>::iterator it)
+    {
+        freeBlocks.bySize.erase({it->second, it->first});
+        freeBlocks.tree.erase(it->first);
+        freeBlocks.byAddr.erase(it);
+    }
+
+    void Allocator::setStrategy(Ref<AllocStrategy> strategy)
+    {
+        // blocks already placed were rounded by the old strategy
+        IT_ASSERT(used == 0 && peak == 0);
+        this->strategy = strategy;
+    }
+
+    void Allocator::startTrace()
+    {
+        // blocks allocated earlier could not be named by their frees
+        IT_ASSERT(used == 0 && peak == 0);
+        trace = make_ref<AllocTrace>(alignment);
+    }
+
+    size_t Allocator::getLargestFreeBlock() const
+    {
+        return freeBlocks.bySize.empty() ? 0 : freeBlocks.bySize.rbegin()->first;
+    }
 
     void *Allocator::getPtr()
     {
         if (this->ptr == nullptr)
         {
+            auto begin = std::chrono::steady_clock::now();
             this->ptr = runtime->alloc(this->peak);
-            printf("Allocator really alloc: %p %lu bytes\n", this->ptr, peak);
+            this->arena = Ref<void>(this->ptr, [runtime = this->runtime](void *ptr)
+                                    { runtime->dealloc(ptr); });
+            std::chrono::duration<double, std::milli> elapsed =
+                std::chrono::steady_clock::now() - begin;
+            IT_ASSERT(reinterpret_cast<uintptr_t>(this->ptr) % alignment == 0,
+                      "Runtime returned memory with a smaller alignment");
+            printf("Allocator really alloc: %p %lu bytes in %.3f ms\n",
+                   this->ptr, peak, elapsed.count());
         }
         return this->ptr;
     }
@@ -126,6 +207,200 @@ namespace infini
     {
         std::cout << "Used memory: " << this->used
                   << ", peak memory: " << this->peak << std::endl;
+        // The lower bound is the most bytes ever live at once, the rest of
+        // the peak is lost to fragmentation, alignment and rounding.
+        size_t wasted = peak - maxLive;
+        std::cout << "Strategy: " << strategy->toString()
+                  << ", free blocks: " << getFreeBlockCount()
+                  << ", largest free block: " << getLargestFreeBlock()
+                  << ", lower bound: " << maxLive << ", wasted: " << wasted
+                  << " (" << (peak ? 100.0 * wasted / peak : 0.0) << "%)"
+                  << std::endl;
+    }
+
+    optional<size_t> FirstFitStrategy::find(const FreeBlocks &blocks,
+                                            size_t size) const
+    {
+        // 从可用内存块的开始位置查找第一个满足需求的内存块，由 tree 在 O(log n) 内完成
+        return blocks.tree.firstFit(size);
+    }
+
+    void FreeBlockTree::insert(size_t addr, size_t size)
+    {
+        // xorshift: priorities only need to be spread out, not unpredictable
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        int t;
+        if (unused.empty()) {
+            t = nodes.size();
+            nodes.emplace_back();
+        } else {
+            t = unused.back();
+            unused.pop_back();
+        }
+        nodes[t] = {addr, size, size, seed, -1, -1};
+        root = insert(root, t);
+    }
+
+    int FreeBlockTree::insert(int t, int node)
+    {
+        if (t < 0) {
+            return node;
+        }
+        if (nodes[node].priority > nodes[t].priority) {
+            split(t, nodes[node].addr, nodes[node].left, nodes[node].right);
+            update(node);
+            return node;
+        }
+        if (nodes[node].addr < nodes[t].addr) {
+            nodes[t].left = insert(nodes[t].left, node);
+        } else {
+            nodes[t].right = insert(nodes[t].right, node);
+        }
+        update(t);
+        return t;
+    }
+
+    void FreeBlockTree::move(size_t addr, size_t newAddr, size_t size)
+    {
+        move(root, addr, newAddr, size);
+    }
+
+    void FreeBlockTree::move(int t, size_t addr, size_t newAddr, size_t size)
+    {
+        // Only the path to the node changes: its place in the address order,
+        // and so its priority, stay the same.
+        IT_ASSERT(t >= 0);
+        if (nodes[t].addr == addr) {
+            nodes[t].addr = newAddr;
+            nodes[t].size = size;
+        } else {
+            move(addr < nodes[t].addr ? nodes[t].left : nodes[t].right, addr,
+                 newAddr, size);
+        }
+        update(t);
+    }
+
+    void FreeBlockTree::erase(size_t addr)
+    {
+        root = erase(root, addr);
+    }
+
+    int FreeBlockTree::erase(int t, size_t addr)
+    {
+        IT_ASSERT(t >= 0);
+        if (nodes[t].addr == addr) {
+            unused.emplace_back(t);
+            return merge(nodes[t].left, nodes[t].right);
+        }
+        if (addr < nodes[t].addr) {
+            nodes[t].left = erase(nodes[t].left, addr);
+        } else {
+            nodes[t].right = erase(nodes[t].right, addr);
+        }
+        update(t);
+        return t;
+    }
+
+    optional<size_t> FreeBlockTree::firstFit(size_t size) const
+    {
+        if (maxSize(root) < size) {
+            return std::nullopt;
+        }
+        // Some block of the subtree fits: go left whenever the left subtree
+        // has one, the first fit is there.
+        int t = root;
+        while (true) {
+            const auto &node = nodes[t];
+            if (maxSize(node.left) >= size) {
+                t = node.left;
+            } else if (node.size >= size) {
+                return node.addr;
+            } else {
+                t = node.right;
+            }
+        }
+    }
+
+    void FreeBlockTree::update(int t)
+    {
+        auto &node = nodes[t];
+        node.maxSize =
+            std::max({node.size, maxSize(node.left), maxSize(node.right)});
+    }
+
+    void FreeBlockTree::split(int t, size_t addr, int &below, int &rest)
+    {
+        if (t < 0) {
+            below = rest = -1;
+        } else if (nodes[t].addr < addr) {
+            split(nodes[t].right, addr, nodes[t].right, rest);
+            below = t;
+            update(t);
+        } else {
+            split(nodes[t].left, addr, below, nodes[t].left);
+            rest = t;
+            update(t);
+        }
+    }
+
+    int FreeBlockTree::merge(int a, int b)
+    {
+        if (a < 0 || b < 0) {
+            return a < 0 ? b : a;
+        }
+        if (nodes[a].priority > nodes[b].priority) {
+            nodes[a].right = merge(nodes[a].right, b);
+            update(a);
+            return a;
+        }
+        nodes[b].left = merge(a, nodes[b].left);
+        update(b);
+        return b;
+    }
+
+    optional<size_t> BestFitStrategy::find(const FreeBlocks &blocks,
+                                           size_t size) const
+    {
+        auto it = blocks.bySize.lower_bound({size, 0});
+        if (it == blocks.bySize.end()) {
+            return std::nullopt;
+        }
+        return it->second;
+    }
+
+    optional<size_t> WorstFitStrategy::find(const FreeBlocks &blocks,
+                                            size_t size) const
+    {
+        if (blocks.bySize.empty() || blocks.bySize.rbegin()->first < size) {
+            return std::nullopt;
+        }
+        // the lowest address among the largest blocks
+        auto largest = blocks.bySize.rbegin()->first;
+        return blocks.bySize.lower_bound({largest, 0})->second;
+    }
+
+    size_t SizeClassStrategy::roundSize(size_t size) const
+    {
+        // classes 4, 5, 6, 7 << k: at most 25% of a request is padding
+        if (size <= 4) {
+            return size;
+        }
+        size_t step = size_t(1) << (63 - __builtin_clzll(size - 1) - 2);
+        return (size + step - 1) / step * step;
+    }
+
+    optional<size_t> SizeClassStrategy::find(const FreeBlocks &blocks,
+                                             size_t size) const
+    {
+        // 'size' is already rounded to its class, so the smallest block that
+        // fits is in the smallest class able to serve it.
+        auto it = blocks.bySize.lower_bound({size, 0});
+        if (it == blocks.bySize.end()) {
+            return std::nullopt;
+        }
+        return it->second;
     }
 }
 
@@ -0,0 +1,153 @@
+#include "core/async_runner.h"
+#include "core/runtime.h"
+#include <algorithm>
+#include <cstring>
+
+namespace infini
+{
+    namespace
+    {
+        std::exception_ptr cancelled(uint64_t id)
+        {
+            return std::make_exception_ptr(
+                Exception("Request " + std::to_string(id) + " was cancelled"));
+        }
+    } // namespace
+
+    AsyncRunnerObj::AsyncRunnerObj(Graph graph, TensorVec inputs,
+                                   TensorVec outputs, int workers,
+                                   size_t capacity)
+        : graph(std::move(graph)), inputs(std::move(inputs)),
+          outputs(std::move(outputs)), capacity(capacity)
+    {
+        IT_ASSERT(workers > 0 && capacity > 0);
+        // Contexts are made up front, so a graph that is not planned fails
+        // here rather than in a worker.
+        vector<ExecutionContext> contexts;
+        for (int i = 0; i < workers; ++i)
+            contexts.emplace_back(make_ref<ExecutionContextObj>(this->graph));
+        for (const auto &tensor : this->inputs)
+            contexts.front()->getTensor(tensor);
+        for (const auto &tensor : this->outputs)
+            contexts.front()->getTensor(tensor);
+        for (auto &context : contexts)
+            this->workers.emplace_back(&AsyncRunnerObj::loop, this, context);
+    }
+
+    AsyncRunnerObj::~AsyncRunnerObj()
+    {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+            for (auto &request : queue)
+                request.done.set_exception(cancelled(request.id));
+            queue.clear();
+        }
+        queued.notify_all();
+        dequeued.notify_all();
+        for (auto &worker : workers)
+            worker.join();
+    }
+
+    AsyncRunnerObj::Ticket AsyncRunnerObj::submit(vector<const void *> inputs,
+                                                  vector<void *> outputs)
+    {
+        IT_ASSERT(inputs.size() == this->inputs.size() &&
+                      outputs.size() == this->outputs.size(),
+                  "Expected " + std::to_string(this->inputs.size()) +
+                      " inputs and " + std::to_string(this->outputs.size()) +
+                      " outputs");
+        Request request{0, std::move(inputs), std::move(outputs), {}};
+        Ticket ticket{0, request.done.get_future()};
+        {
+            std::unique_lock<std::mutex> lock(this->lock);
+            dequeued.wait(lock, [&]
+                          { return stopping || queue.size() < capacity; });
+            IT_ASSERT(!stopping);
+            ticket.id = request.id = nextId++;
+            queue.emplace_back(std::move(request));
+        }
+        queued.notify_one();
+        return ticket;
+    }
+
+    bool AsyncRunnerObj::cancel(uint64_t id)
+    {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            auto it = std::find_if(queue.begin(), queue.end(),
+                                   [id](const Request &request)
+                                   { return request.id == id; });
+            if (it == queue.end())
+                return false;
+            it->done.set_exception(cancelled(id));
+            queue.erase(it);
+        }
+        dequeued.notify_one();
+        return true;
+    }
+
+    size_t AsyncRunnerObj::pending()
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        return queue.size() + running;
+    }
+
+    void AsyncRunnerObj::loop(ExecutionContext context)
+    {
+        auto runtime = graph->getRuntime();
+        while (true)
+        {
+            Request request;
+            {
+                std::unique_lock<std::mutex> lock(this->lock);
+                queued.wait(lock, [&]
+                            { return stopping || !queue.empty(); });
+                if (queue.empty())
+                    return; // stopping
+                request = std::move(queue.front());
+                queue.pop_front();
+                ++running;
+            }
+            dequeued.notify_one();
+
+            try
+            {
+                // External tensors are bound to the request's buffers, the
+                // others are copied in and out of the context's arena.
+                for (size_t i = 0; i < inputs.size(); ++i)
+                {
+                    auto data = const_cast<void *>(request.inputs[i]);
+                    if (inputs[i]->isExternal())
+                    {
+                        context->bind(inputs[i], data);
+                        continue;
+                    }
+                    auto tensor = context->getTensor(inputs[i]);
+                    std::memcpy(tensor->getRawDataPtr<void *>(), data,
+                                tensor->getBytes());
+                }
+                for (size_t i = 0; i < outputs.size(); ++i)
+                    if (outputs[i]->isExternal())
+                        context->bind(outputs[i], request.outputs[i]);
+                runtime->run(graph, context);
+                for (size_t i = 0; i < outputs.size(); ++i)
+                {
+                    if (outputs[i]->isExternal())
+                        continue;
+                    auto tensor = context->getTensor(outputs[i]);
+                    std::memcpy(request.outputs[i],
+                                tensor->getRawDataPtr<void *>(),
+                                tensor->getBytes());
+                }
+                request.done.set_value();
+            }
+            catch (...)
+            {
+                request.done.set_exception(std::current_exception());
+            }
+            std::lock_guard<std::mutex> guard(lock);
+            --running;
+        }
+    }
+} // namespace infini
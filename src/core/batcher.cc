@@ -0,0 +1,216 @@
+#include "core/batcher.h"
+#include "core/runtime.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <sstream>
+
+namespace infini
+{
+    double BatcherObj::Stats::throughput() const
+    {
+        return seconds > 0 ? requests / seconds : 0;
+    }
+
+    double BatcherObj::Stats::meanBatch() const
+    {
+        return batches > 0 ? double(requests) / batches : 0;
+    }
+
+    void BatcherObj::Stats::record(double ms)
+    {
+        auto bucket = ms > minBucket
+                          ? int(std::log2(ms / minBucket) * bucketsPerOctave)
+                          : 0;
+        ++histogram[std::min(bucket, nBuckets - 1)];
+        bool first = requests == 0;
+        minLatency = first ? ms : std::min(minLatency, ms);
+        maxLatency = first ? ms : std::max(maxLatency, ms);
+        ++requests;
+    }
+
+    double BatcherObj::Stats::percentile(double p) const
+    {
+        if (requests == 0)
+            return 0;
+        if (p <= 0)
+            return minLatency;
+        if (p >= 1)
+            return maxLatency;
+        // the rank the sorted latencies would give
+        auto rank = std::min(size_t(p * (requests - 1) + 0.5), requests - 1);
+        size_t seen = 0;
+        int bucket = 0;
+        while (seen + histogram[bucket] <= rank)
+            seen += histogram[bucket++];
+        // the geometric middle of the bucket
+        auto ms = minBucket * std::exp2((bucket + 0.5) / bucketsPerOctave);
+        return std::clamp(ms, minLatency, maxLatency);
+    }
+
+    string BatcherObj::Stats::toString() const
+    {
+        std::ostringstream oss;
+        oss << requests << " requests in " << batches << " batches (mean "
+            << meanBatch() << "), " << throughput() << " req/s, latency p50 "
+            << percentile(0.5) << " ms, p99 " << percentile(0.99) << " ms";
+        return oss.str();
+    }
+
+    BatcherObj::BatcherObj(Builder build, int maxBatch,
+                           Clock::duration maxDelay)
+        : build(std::move(build)), maxBatch(maxBatch), maxDelay(maxDelay)
+    {
+        IT_ASSERT(maxBatch > 0);
+        const auto &single = graphFor(1);
+        for (const auto &input : single.inputs)
+            inputBytes.emplace_back(input->getBytes());
+        for (const auto &output : single.outputs)
+            outputBytes.emplace_back(output->getBytes());
+        worker = std::thread(&BatcherObj::loop, this);
+    }
+
+    BatcherObj::~BatcherObj()
+    {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+        }
+        cond.notify_all();
+        worker.join();
+    }
+
+    std::future<void> BatcherObj::submit(vector<const void *> inputs,
+                                         vector<void *> outputs)
+    {
+        IT_ASSERT(inputs.size() == inputBytes.size() &&
+                      outputs.size() == outputBytes.size(),
+                  "Expected " + std::to_string(inputBytes.size()) +
+                      " inputs and " + std::to_string(outputBytes.size()) +
+                      " outputs");
+        Request request{std::move(inputs), std::move(outputs), {}, Clock::now()};
+        auto future = request.done.get_future();
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            IT_ASSERT(!stopping);
+            if (stats.requests == 0 && queue.empty())
+                first = request.arrival;
+            queue.emplace_back(std::move(request));
+        }
+        cond.notify_all();
+        return future;
+    }
+
+    BatcherObj::Stats BatcherObj::getStats()
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        return stats;
+    }
+
+    void BatcherObj::resetStats()
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stats = {};
+        first = Clock::now();
+    }
+
+    const BatchedGraph &BatcherObj::graphFor(int batch)
+    {
+        auto it = graphs.find(batch);
+        if (it != graphs.end())
+            return it->second;
+        auto batched = build(batch);
+        IT_ASSERT(batched.graph != nullptr && !batched.inputs.empty());
+        auto check = [&](const TensorVec &tensors, const vector<size_t> &bytes)
+        {
+            IT_ASSERT(bytes.empty() || tensors.size() == bytes.size(),
+                      "The graph for batch " + std::to_string(batch) +
+                          " has a different number of inputs or outputs");
+            for (size_t i = 0; i < tensors.size(); ++i)
+            {
+                const auto &tensor = tensors[i];
+                IT_ASSERT(tensor->getRank() > 0 &&
+                              tensor->getDims()[0] == batch &&
+                              (bytes.empty() ||
+                               tensor->getBytes() == bytes[i] * batch),
+                          "Tensor " + std::to_string(tensor->getGuid()) +
+                              " is not batched by " + std::to_string(batch));
+            }
+        };
+        check(batched.inputs, inputBytes);
+        check(batched.outputs, outputBytes);
+        batched.graph->dataMalloc();
+        return graphs.emplace(batch, std::move(batched)).first->second;
+    }
+
+    void BatcherObj::loop()
+    {
+        while (true)
+        {
+            vector<Request> batch;
+            {
+                std::unique_lock<std::mutex> lock(this->lock);
+                cond.wait(lock, [&]
+                          { return stopping || !queue.empty(); });
+                if (queue.empty())
+                    return; // stopping
+                // Wait for a full batch until the oldest request is due.
+                auto deadline = queue.front().arrival + maxDelay;
+                cond.wait_until(lock, deadline, [&]
+                                { return stopping ||
+                                         int(queue.size()) >= maxBatch; });
+                auto n = std::min<size_t>(queue.size(), maxBatch);
+                for (size_t i = 0; i < n; ++i)
+                {
+                    batch.emplace_back(std::move(queue.front()));
+                    queue.pop_front();
+                }
+            }
+            runBatch(batch);
+        }
+    }
+
+    void BatcherObj::runBatch(vector<Request> &batch)
+    {
+        int n = batch.size();
+        try
+        {
+            const auto &batched = graphFor(n);
+            for (size_t i = 0; i < inputBytes.size(); ++i)
+            {
+                auto dst = batched.inputs[i]->getRawDataPtr<char *>();
+                for (int j = 0; j < n; ++j)
+                    std::memcpy(dst + j * inputBytes[i], batch[j].inputs[i],
+                                inputBytes[i]);
+            }
+            batched.graph->getRuntime()->run(batched.graph);
+            for (size_t i = 0; i < outputBytes.size(); ++i)
+            {
+                auto src = batched.outputs[i]->getRawDataPtr<char *>();
+                for (int j = 0; j < n; ++j)
+                    std::memcpy(batch[j].outputs[i], src + j * outputBytes[i],
+                                outputBytes[i]);
+            }
+        }
+        catch (...)
+        {
+            for (auto &request : batch)
+                request.done.set_exception(std::current_exception());
+            return;
+        }
+
+        auto now = Clock::now();
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stats.batches += 1;
+            stats.seconds =
+                std::chrono::duration<double>(now - first).count();
+            for (const auto &request : batch)
+                stats.record(std::chrono::duration<double, std::milli>(
+                                 now - request.arrival)
+                                 .count());
+        }
+        for (auto &request : batch)
+            request.done.set_value();
+    }
+} // namespace infini
@@ -0,0 +1,494 @@
+#include "core/codegen.h"
+#include "operators/concat.h"
+#include "operators/transpose.h"
+#include "operators/unary.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace infini
+{
+    string cTypeOf(DataType dtype)
+    {
+        switch (dtype.getIndex())
+        {
+        case 1: // Float32
+            return "float";
+        case 2: // UInt8
+            return "uint8_t";
+        case 3: // Int8
+            return "int8_t";
+        case 4: // UInt16
+            return "uint16_t";
+        case 5: // Int16
+            return "int16_t";
+        case 6: // Int32
+            return "int32_t";
+        case 7: // Int64
+            return "int64_t";
+        case 9: // Bool
+            return "bool";
+        case 11: // Double
+            return "double";
+        case 12: // UInt32
+            return "uint32_t";
+        case 13: // UInt64
+            return "uint64_t";
+        default:
+            IT_TODO_HALT_MSG("No C++ type for " + dtype.toString());
+        }
+        return {};
+    }
+
+    string floatLiteral(float value)
+    {
+        std::ostringstream oss;
+        oss << std::hexfloat << value << "f";
+        return oss.str();
+    }
+
+    string elementExpr(const Operator &op, const vector<string> &args)
+    {
+        auto type = cTypeOf(op->getOutput()->getDType());
+        switch (op->getOpType().underlying())
+        {
+        case OpType::Add:
+            return args[0] + " + " + args[1];
+        case OpType::Sub:
+            return args[0] + " - " + args[1];
+        case OpType::Mul:
+            return args[0] + " * " + args[1];
+        case OpType::Div:
+            return "(" + type + ")(" + args[0] + " / " + args[1] + ")";
+        case OpType::Relu:
+            return "std::max(" + type + "(0), " + args[0] + ")";
+        case OpType::Clip:
+        {
+            // Compared with the float bounds as the kernel does.
+            auto clip = as<ClipObj>(op);
+            auto expr = args[0];
+            if (auto max = clip->getMax())
+                expr = args[0] + " > " + floatLiteral(*max) + " ? " + type +
+                       "(" + floatLiteral(*max) + ") : " + expr;
+            if (auto min = clip->getMin())
+                expr = args[0] + " < " + floatLiteral(*min) + " ? " + type +
+                       "(" + floatLiteral(*min) + ") : " + expr;
+            return expr;
+        }
+        default:
+            IT_TODO_HALT_MSG("No expression for " + op->getOpType().toString());
+        }
+        return {};
+    }
+
+    Shape broadcastStride(const Tensor &tensor, const Shape &dims)
+    {
+        auto shape = tensor->getDims();
+        auto stride = tensor->getStride();
+        Shape ret(dims.size(), 0);
+        auto skip = dims.size() - shape.size();
+        for (size_t i = 0; i < shape.size(); ++i)
+            ret[skip + i] = shape[i] == 1 ? 0 : stride[i];
+        return ret;
+    }
+
+    void emitLoops(std::ostream &os, const Shape &dims,
+                   const vector<LoopOperand> &operands, string expr,
+                   const vector<string> &lets, int indent)
+    {
+        Shape loops;
+        vector<Shape> strides(operands.size());
+        for (size_t d = 0; d < dims.size(); ++d)
+        {
+            if (dims[d] == 1)
+                continue;
+            bool merge = !loops.empty();
+            for (size_t k = 0; merge && k < operands.size(); ++k)
+                merge = strides[k].back() == operands[k].stride[d] * dims[d];
+            if (merge)
+                loops.back() *= dims[d];
+            else
+                loops.emplace_back(dims[d]);
+            for (size_t k = 0; k < operands.size(); ++k)
+            {
+                if (merge)
+                    strides[k].back() = operands[k].stride[d];
+                else
+                    strides[k].emplace_back(operands[k].stride[d]);
+            }
+        }
+
+        auto element = [&](size_t k)
+        {
+            string index;
+            for (size_t i = 0; i < loops.size(); ++i)
+            {
+                auto stride = strides[k][i];
+                if (stride == 0)
+                    continue;
+                if (!index.empty())
+                    index += " + ";
+                index += "i" + std::to_string(i);
+                if (stride != 1)
+                    index += " * " + std::to_string(stride);
+            }
+            return operands[k].ptr + "[" + (index.empty() ? "0" : index) + "]";
+        };
+        auto substitute = [&](string code)
+        {
+            for (size_t k = operands.size() - 1; k > 0; --k)
+            {
+                auto name = "$" + std::to_string(k);
+                for (auto pos = code.find(name); pos != string::npos;
+                     pos = code.find(name, pos))
+                    code.replace(pos, name.size(), element(k));
+            }
+            return code;
+        };
+
+        string pad(indent, ' ');
+        for (size_t i = 0; i < loops.size(); ++i)
+        {
+            auto var = "i" + std::to_string(i);
+            os << pad << "for (size_t " << var << " = 0; " << var << " < "
+               << loops[i] << "; ++" << var << ")\n";
+            pad += "    ";
+        }
+        if (lets.empty())
+        {
+            os << pad << element(0) << " = " << substitute(expr) << ";\n";
+            return;
+        }
+        os << pad << "{\n";
+        for (const auto &let : lets)
+            os << pad << "    " << substitute(let) << "\n";
+        os << pad << "    " << element(0) << " = " << substitute(expr) << ";\n"
+           << pad << "}\n";
+    }
+
+    namespace
+    {
+        class CppGenerator
+        {
+            // Memory the tensors point into, and the expression of its first
+            // byte in the generated source.
+            struct Region
+            {
+                const char *begin;
+                size_t bytes;
+                string base;
+                bool writable;
+            };
+
+            Graph graph;
+            vector<Region> regions;
+            std::ostringstream os;
+
+        public:
+            explicit CppGenerator(const Graph &graph) : graph(graph) {}
+
+            string generate(const TensorVec &inputs, const TensorVec &outputs,
+                            size_t arenaBytes, const char *arena,
+                            const std::unordered_map<TensorObj *, size_t>
+                                &arenaOffset)
+            {
+                std::ostringstream body;
+                if (arenaBytes > 0)
+                    regions.push_back({arena, arenaBytes, "arena", true});
+                // External inputs and outputs are read and written in place,
+                // the others are copied in and out of the arena.
+                size_t inBytes = 0, outBytes = 0;
+                vector<string> copyOut;
+                for (const auto &input : inputs)
+                {
+                    auto bytes = input->getBytes();
+                    auto it = arenaOffset.find(input.get());
+                    if (it == arenaOffset.end())
+                        regions.push_back({input->getRawDataPtr<char *>(),
+                                           bytes, offset("in", inBytes),
+                                           false});
+                    else
+                        body << "    std::memcpy(" << offset("arena", it->second)
+                             << ", " << offset("in", inBytes) << ", " << bytes
+                             << ");\n";
+                    inBytes += bytes;
+                }
+                for (const auto &output : outputs)
+                {
+                    IT_ASSERT(!output->isView(),
+                              "Output " + std::to_string(output->getGuid()) +
+                                  " is a view");
+                    auto bytes = output->getBytes();
+                    auto it = arenaOffset.find(output.get());
+                    if (it == arenaOffset.end())
+                        regions.push_back({output->getRawDataPtr<char *>(),
+                                           bytes, offset("out", outBytes),
+                                           true});
+                    else
+                        copyOut.emplace_back(
+                            "    std::memcpy(" + offset("out", outBytes) + ", " +
+                            offset("arena", it->second) + ", " +
+                            std::to_string(bytes) + ");\n");
+                    outBytes += bytes;
+                }
+
+                os << "// Generated by InfiniTensor from a graph of "
+                   << graph->getOperators().size() << " operators.\n"
+                   << "// in: " << inBytes << " bytes, out: " << outBytes
+                   << " bytes.\n"
+                   << "#include <algorithm>\n#include <cstddef>\n"
+                   << "#include <cstdint>\n#include <cstring>\n\n"
+                   << "namespace\n{\n";
+                if (arenaBytes > 0)
+                    os << "alignas(64) unsigned char arena[" << arenaBytes
+                       << "];\n";
+                // Weights, i.e. tensors with no source that are not inputs,
+                // are embedded wherever they are bound. Those outside the
+                // arena are read from the embedded copy. Those set in the
+                // arena, e.g. by setData after dataMalloc, are copied into
+                // their slot first, as the static arena starts zeroed.
+                for (const auto &tensor : graph->getTensors())
+                {
+                    if (tensor->getSource() || !tensor->getDataBlob() ||
+                        std::find(inputs.begin(), inputs.end(), tensor) !=
+                            inputs.end())
+                        continue;
+                    auto region = find(tensor);
+                    if (region != nullptr && region->base != "arena")
+                        continue;
+                    auto name = "w" + std::to_string(tensor->getGuid());
+                    embed(name, tensor);
+                    if (region == nullptr)
+                    {
+                        regions.push_back({tensor->getRawDataPtr<char *>(),
+                                           tensor->getBytes(), name, false});
+                        continue;
+                    }
+                    body << "    std::memcpy("
+                         << offset("arena", tensor->getRawDataPtr<char *>() -
+                                                region->begin)
+                         << ", " << name << ", " << tensor->getBytes()
+                         << ");\n";
+                }
+                os << "} // namespace\n\n"
+                   << "extern \"C\" void infer(const void *in_, void *out_)\n"
+                   << "{\n"
+                   << "    auto in = static_cast<const unsigned char *>(in_);\n"
+                   << "    auto out = static_cast<unsigned char *>(out_);\n"
+                   << "    (void)in;\n    (void)out;\n"
+                   << body.str();
+                for (const auto &op : graph->getOperators())
+                    emit(op);
+                for (const auto &copy : copyOut)
+                    os << copy;
+                os << "}\n";
+                return os.str();
+            }
+
+        private:
+            static string offset(const string &base, size_t bytes)
+            {
+                return bytes ? "(" + base + " + " + std::to_string(bytes) + ")"
+                             : base;
+            }
+
+            const Region *find(const Tensor &tensor) const
+            {
+                auto ptr = tensor->getRawDataPtr<char *>();
+                for (const auto &region : regions)
+                    if (ptr >= region.begin && ptr < region.begin + region.bytes)
+                        return &region;
+                return nullptr;
+            }
+
+            void embed(const string &name, const Tensor &tensor)
+            {
+                auto data = tensor->getRawDataPtr<unsigned char *>();
+                auto bytes = tensor->getBytes();
+                os << "alignas(64) const unsigned char " << name << "[" << bytes
+                   << "] = {";
+                for (size_t i = 0; i < bytes; ++i)
+                    os << (i % 16 ? " " : "\n    ") << "0x" << std::hex
+                       << std::setw(2) << std::setfill('0') << int(data[i])
+                       << std::dec << ",";
+                os << "\n};\n";
+            }
+
+            // Declares a typed pointer to 'tensor', named after its guid.
+            string declare(const Tensor &tensor, bool write)
+            {
+                auto region = find(tensor);
+                IT_ASSERT(region != nullptr,
+                          "Tensor " + std::to_string(tensor->getGuid()) +
+                              " is not bound to memory the generator knows");
+                IT_ASSERT(!write || region->writable,
+                          "Tensor " + std::to_string(tensor->getGuid()) +
+                              " is written in place of an input or weight");
+                auto name = "t" + std::to_string(tensor->getGuid());
+                auto type = cTypeOf(tensor->getDType());
+                os << "        auto " << name << " = reinterpret_cast<"
+                   << (write ? "" : "const ") << type << " *>(" << region->base;
+                if (auto bytes = tensor->getRawDataPtr<char *>() - region->begin)
+                    os << " + " << bytes;
+                os << ");\n";
+                return name;
+            }
+
+            void emit(const Operator &op)
+            {
+                auto output = op->getOutput();
+                os << "    // " << op->getOpType().toString() << " "
+                   << op->getGuid() << "\n";
+                // Views read their input through strides in place.
+                if (output->isView())
+                    return;
+                auto dims = output->getDims();
+                switch (op->getOpType().underlying())
+                {
+                case OpType::Add:
+                case OpType::Sub:
+                case OpType::Mul:
+                case OpType::Div:
+                {
+                    os << "    {\n";
+                    auto a = declare(op->getInputs(0), false);
+                    auto b = declare(op->getInputs(1), false);
+                    auto c = declare(output, true);
+                    emitLoops(os, dims,
+                              {{c, output->getStride()},
+                               {a, broadcastStride(op->getInputs(0), dims)},
+                               {b, broadcastStride(op->getInputs(1), dims)}},
+                              elementExpr(op, {"$1", "$2"}));
+                    os << "    }\n";
+                    return;
+                }
+                case OpType::Relu:
+                case OpType::Clip:
+                {
+                    os << "    {\n";
+                    auto x = declare(op->getInputs(0), false);
+                    auto y = declare(output, true);
+                    emitLoops(os, dims,
+                              {{y, output->getStride()},
+                               {x, broadcastStride(op->getInputs(0), dims)}},
+                              elementExpr(op, {"$1"}));
+                    os << "    }\n";
+                    return;
+                }
+                case OpType::Transpose:
+                {
+                    os << "    {\n";
+                    auto input = op->getInputs(0);
+                    auto x = declare(input, false);
+                    auto y = declare(output, true);
+                    auto perm = as<TransposeObj>(op)->getPermute();
+                    auto inStride = input->getStride();
+                    Shape stride;
+                    for (auto p : perm)
+                        stride.emplace_back(inStride[p]);
+                    emitLoops(os, dims, {{y, output->getStride()}, {x, stride}},
+                              "$1");
+                    os << "    }\n";
+                    return;
+                }
+                case OpType::Concat:
+                {
+                    auto dim = as<ConcatObj>(op)->getDim();
+                    auto outStride = output->getStride();
+                    auto outPtr = output->getRawDataPtr<char *>();
+                    auto elemSize = output->getDType().getSize();
+                    os << "    {\n";
+                    auto y = declare(output, true);
+                    size_t sliceOffset = 0;
+                    for (const auto &input : op->getInputs())
+                    {
+                        auto begin = sliceOffset;
+                        sliceOffset += input->getDims()[dim] * outStride[dim];
+                        // dataMalloc produced it in its slice already.
+                        if (input->isContiguous() &&
+                            input->getRawDataPtr<char *>() ==
+                                outPtr + begin * elemSize)
+                            continue;
+                        auto x = declare(input, false);
+                        emitLoops(os, input->getDims(),
+                                  {{"(" + y + " + " + std::to_string(begin) + ")",
+                                    outStride},
+                                   {x, input->getStride()}},
+                                  "$1");
+                    }
+                    os << "    }\n";
+                    return;
+                }
+                case OpType::Reshape:
+                case OpType::Flatten:
+                case OpType::Squeeze:
+                case OpType::Unsqueeze:
+                {
+                    auto input = op->getInputs(0);
+                    if (input->getRawDataPtr<void *>() ==
+                        output->getRawDataPtr<void *>())
+                        return;
+                    os << "    {\n";
+                    auto x = declare(input, false);
+                    auto y = declare(output, true);
+                    os << "        std::memcpy(" << y << ", " << x << ", "
+                       << output->getBytes() << ");\n    }\n";
+                    return;
+                }
+                default:
+                    IT_TODO_HALT_MSG("No code generator for " +
+                                     op->getOpType().toString());
+                }
+            }
+        };
+    } // namespace
+
+    string generateCpp(const Graph &graph, const TensorVec &inputs,
+                       const TensorVec &outputs)
+    {
+        IT_ASSERT(graph->allocated, "Call dataMalloc before generating code");
+        auto arena = static_cast<const char *>(graph->allocator.getArena().get());
+        return CppGenerator(graph).generate(inputs, outputs,
+                                            arena ? graph->allocator.getPeak()
+                                                  : 0,
+                                            arena, graph->arenaOffset);
+    }
+
+    void compileCpp(const string &source, const string &library,
+                    const string &compiler, const string &flags)
+    {
+        auto path = library + ".cc";
+        {
+            std::ofstream file(path);
+            file << source;
+            IT_ASSERT(file.good(), "Failed to write " + path);
+        }
+        // No shell is involved: paths are passed as they are, whatever
+        // characters they contain.
+        vector<string> args;
+        std::istringstream words(compiler + " -std=c++17 -shared -fPIC " +
+                                 flags);
+        for (string word; words >> word;)
+            args.emplace_back(word);
+        args.insert(args.end(), {path, "-o", library});
+        vector<char *> argv;
+        string command;
+        for (auto &arg : args)
+        {
+            argv.emplace_back(arg.data());
+            command += (command.empty() ? "" : " ") + arg;
+        }
+        argv.emplace_back(nullptr);
+
+        pid_t pid;
+        int status = posix_spawnp(&pid, argv[0], nullptr, nullptr, argv.data(),
+                                  environ);
+        IT_ASSERT(status == 0, "Failed to run " + command);
+        IT_ASSERT(waitpid(pid, &status, 0) == pid && WIFEXITED(status) &&
+                      WEXITSTATUS(status) == 0,
+                  "Failed: " + command);
+    }
+} // namespace infini
@@ -0,0 +1,155 @@
+#include "core/dlpack.h"
+
+namespace infini
+{
+    namespace
+    {
+        DLDataType toDLDataType(DataType dtype)
+        {
+            auto bits = uint8_t(dtype.getSize() * 8);
+            switch (dtype.getIndex())
+            {
+            case 1:  // Float32
+            case 10: // Float16
+            case 11: // Double
+                return {kDLFloat, bits, 1};
+            case 2:  // UInt8
+            case 4:  // UInt16
+            case 12: // UInt32
+            case 13: // UInt64
+                return {kDLUInt, bits, 1};
+            case 3: // Int8
+            case 5: // Int16
+            case 6: // Int32
+            case 7: // Int64
+                return {kDLInt, bits, 1};
+            case 9: // Bool
+                return {kDLBool, bits, 1};
+            case 16: // BFloat16
+                return {kDLBfloat, bits, 1};
+            default:
+                IT_TODO_HALT_MSG("No DLPack type for " + dtype.toString());
+            }
+            return {};
+        }
+
+        DataType fromDLDataType(DLDataType type)
+        {
+            for (int i = 1; i < int(std::size(DataType::names)); ++i)
+            {
+                DataType dtype(i);
+                if (dtype.getSize() == 0 || dtype == DataType::String)
+                    continue;
+                auto candidate = toDLDataType(dtype);
+                if (candidate.code == type.code && candidate.bits == type.bits &&
+                    type.lanes == 1)
+                    return dtype;
+            }
+            IT_TODO_HALT_MSG("Unsupported DLPack type code " +
+                             std::to_string(type.code) + " with " +
+                             std::to_string(type.bits) + " bits and " +
+                             std::to_string(type.lanes) + " lanes");
+            return DataType::Undefine;
+        }
+
+        // What an exported tensor holds on to.
+        struct ExportContext
+        {
+            Blob blob;
+            vector<int64_t> shape, strides;
+            DLManagedTensor managed;
+        };
+
+        // Takes over 'managed' at once, so that it is released even if it
+        // turns out not to be bindable.
+        Ref<DLManagedTensor> own(DLManagedTensor *managed)
+        {
+            IT_ASSERT(managed != nullptr);
+            return Ref<DLManagedTensor>(managed, [](DLManagedTensor *managed)
+                                        {
+                                            if (managed->deleter)
+                                                managed->deleter(managed); });
+        }
+
+        Shape shapeOf(const DLTensor &dl)
+        {
+            IT_ASSERT(dl.ndim >= 0 && (dl.ndim == 0 || dl.shape != nullptr),
+                      "Malformed DLPack tensor");
+            Shape shape;
+            for (int i = 0; i < dl.ndim; ++i)
+            {
+                IT_ASSERT(dl.shape[i] >= 0 &&
+                              dl.shape[i] <= std::numeric_limits<int>::max(),
+                          "Unsupported DLPack dimension " +
+                              std::to_string(dl.shape[i]));
+                shape.emplace_back(dl.shape[i]);
+            }
+            return shape;
+        }
+
+        void bindManaged(const Tensor &tensor,
+                         const Ref<DLManagedTensor> &owner)
+        {
+            const auto &dl = owner->dl_tensor;
+            IT_ASSERT(dl.device.device_type == kDLCPU,
+                      "Only CPU DLPack tensors can be bound");
+            IT_ASSERT(fromDLDataType(dl.dtype) == tensor->getDType() &&
+                          shapeOf(dl) == tensor->getDims(),
+                      "DLPack tensor does not match tensor " +
+                          std::to_string(tensor->getGuid()));
+            if (dl.strides)
+            {
+                int64_t expected = 1;
+                for (int i = dl.ndim - 1; i >= 0; --i)
+                {
+                    IT_ASSERT(dl.shape[i] == 1 || dl.strides[i] == expected,
+                              "Only row-major DLPack tensors can be bound");
+                    expected *= dl.shape[i];
+                }
+            }
+            auto ptr = static_cast<char *>(dl.data) + dl.byte_offset;
+            tensor->setExternalBlob(
+                make_ref<BlobObj>(tensor->getRuntime(), ptr, owner));
+        }
+    } // namespace
+
+    DLManagedTensor *toDLPack(const Tensor &tensor)
+    {
+        auto blob = tensor->getDataBlob();
+        IT_ASSERT(blob != nullptr, "Tensor " + std::to_string(tensor->getGuid()) +
+                                       " has no memory to export");
+        auto dtype = toDLDataType(tensor->getDType());
+        auto ctx = new ExportContext{blob, {}, {}, {}};
+        for (auto d : tensor->getDims())
+            ctx->shape.emplace_back(d);
+        for (auto s : tensor->getStride())
+            ctx->strides.emplace_back(s);
+
+        auto &managed = ctx->managed;
+        managed.dl_tensor.data = tensor->getRawDataPtr<void *>();
+        managed.dl_tensor.device = {kDLCPU, 0};
+        managed.dl_tensor.ndim = ctx->shape.size();
+        managed.dl_tensor.dtype = dtype;
+        managed.dl_tensor.shape = ctx->shape.data();
+        managed.dl_tensor.strides = ctx->strides.data();
+        managed.dl_tensor.byte_offset = 0;
+        managed.manager_ctx = ctx;
+        managed.deleter = [](DLManagedTensor *self)
+        { delete static_cast<ExportContext *>(self->manager_ctx); };
+        return &managed;
+    }
+
+    void bindDLPack(const Tensor &tensor, DLManagedTensor *managed)
+    {
+        bindManaged(tensor, own(managed));
+    }
+
+    Tensor fromDLPack(const Graph &graph, DLManagedTensor *managed)
+    {
+        auto owner = own(managed);
+        const auto &dl = owner->dl_tensor;
+        auto tensor = graph->addTensor(shapeOf(dl), fromDLDataType(dl.dtype));
+        bindManaged(tensor, owner);
+        return tensor;
+    }
+} // namespace infini
@@ -0,0 +1,81 @@
+#include "core/execution_context.h"
+#include <cstring>
+
+namespace infini
+{
+    ExecutionContextObj::ExecutionContextObj(const Graph &source)
+        : source(source)
+    {
+        IT_ASSERT(source->allocated,
+                  "Call dataMalloc before creating execution contexts");
+        auto runtime = source->getRuntime();
+        graph = make_ref<GraphObj>(runtime, source->getOperators());
+        for (const auto &tensor : graph->getTensors())
+            clones[tensor->getFuid()] = tensor;
+
+        size_t bytes = source->allocator.getPeak();
+        if (bytes > 0)
+        {
+            auto ptr = runtime->alloc(bytes);
+            arena = Ref<void>(ptr, [runtime](void *ptr)
+                              { runtime->dealloc(ptr); });
+        }
+        // Activations move to the private arena; everything else, weights
+        // and whatever the external tensors are bound to now, is shared.
+        for (const auto &tensor : source->getTensors())
+        {
+            auto it = clones.find(tensor->getFuid());
+            if (it == clones.end())
+                continue; // not used by any operator
+            auto clone = it->second;
+            auto offset = source->arenaOffset.find(tensor.get());
+            if (offset != source->arenaOffset.end())
+            {
+                clone->setDataBlob(make_ref<BlobObj>(
+                    runtime, static_cast<char *>(arena.get()) + offset->second,
+                    arena));
+                // Weights set after dataMalloc, e.g. by setData, live in the
+                // source's arena. Tensors with no source are live during the
+                // whole run, so their slot is never reused and one copy lasts
+                // for every run. Inputs are copied as well and get
+                // overwritten.
+                if (!tensor->getSource() && !tensor->isView())
+                    std::memcpy(clone->getRawDataPtr<void *>(),
+                                tensor->getRawDataPtr<void *>(),
+                                tensor->getBytes());
+            }
+            else if (tensor->isExternal())
+                clone->setExternalBlob(tensor->getDataBlob());
+            else
+                clone->setDataBlob(tensor->getDataBlob());
+        }
+        // Bound as the source's plan says, the clones count as planned.
+        graph->allocated = true;
+    }
+
+    Tensor ExecutionContextObj::getTensor(const Tensor &tensor) const
+    {
+        auto it = clones.find(tensor->getFuid());
+        IT_ASSERT(it != clones.end(),
+                  "Tensor " + std::to_string(tensor->getGuid()) +
+                      " is not in the graph of this context");
+        return it->second;
+    }
+
+    void ExecutionContextObj::bind(const Tensor &tensor, void *ptr,
+                                   Ref<void> owner)
+    {
+        IT_ASSERT(tensor->isExternal(),
+                  "Tensor " + std::to_string(tensor->getGuid()) +
+                      " was planned in the arena, call setExternal first");
+        auto runtime = source->getRuntime();
+        auto blob = make_ref<BlobObj>(runtime, ptr, owner);
+        getTensor(tensor)->setExternalBlob(blob);
+        auto it = source->placedIn.find(tensor.get());
+        if (it == source->placedIn.end())
+            return;
+        for (const auto &[placed, offset] : it->second)
+            getTensor(placed)->setDataBlob(make_ref<BlobObj>(
+                runtime, static_cast<char *>(ptr) + offset, blob));
+    }
+} // namespace infini
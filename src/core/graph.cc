@@ -1,5 +1,6 @@
 #include "core/graph.h"
 #include "core/op_type.h"
+#include "operators/concat.h"
 #include "operators/matmul.h"
 #include "operators/transpose.h"
 #include <algorithm>
@@ -39,6 +40,24 @@ namespace infini
         }
     }
 
+    void GraphObj::replaceOperators(const OpVec &ops, const Operator &op)
+    {
+        IT_ASSERT(!ops.empty() && op->getOutput() == ops.back()->getOutput());
+        for (const auto &old : ops)
+        {
+            for (const auto &input : old->getInputs())
+                input->removeTarget(old);
+            for (const auto &pred : old->getPredecessors())
+                pred->removeSuccessors(old);
+            for (const auto &succ : old->getSuccessors())
+                succ->removePredecessors(old);
+            removeOperator(old);
+            if (old != ops.back())
+                removeTensor(old->getOutput());
+        }
+        addOperatorAndConnect(op);
+    }
+
     string GraphObj::toString() const
     {
         std::ostringstream oss;
@@ -102,6 +121,24 @@ namespace infini
     }
 
     
+    // Operators whose kernels can read inputs through arbitrary strides.
+    static bool acceptsStridedInput(const Operator &op)
+    {
+        switch (op->getOpType().underlying())
+        {
+        case OpType::Add:
+        case OpType::Sub:
+        case OpType::Mul:
+        case OpType::Div:
+        case OpType::Relu:
+        case OpType::Clip:
+        case OpType::Transpose:
+        case OpType::Concat:
+            return true;
+        default:
+            return false;
+        }
+    }
 
 void GraphObj::optimize() {
     if (!this->topo_sort()) {
@@ -211,6 +248,28 @@ void GraphObj::optimize() {
             }
         }
     } while (optimized);
+
+    // A Transpose whose consumers all read strided inputs becomes a view on
+    // its input: only the strides are permuted and no data is moved.
+    for (auto &op : ops) {
+        if (op->getOpType() != OpType::Transpose) {
+            continue;
+        }
+        auto output = op->getOutput();
+        auto targets = output->getTargets();
+        if (targets.empty() ||
+            !std::all_of(targets.begin(), targets.end(), acceptsStridedInput)) {
+            continue;
+        }
+        auto input = op->getInputs(0);
+        auto perm = as<TransposeObj>(op)->getPermute();
+        auto inStride = input->getStride();
+        Shape stride(perm.size());
+        for (size_t j = 0; j < perm.size(); ++j) {
+            stride[j] = inStride[perm[j]];
+        }
+        output->setView(stride, input->getOffset());
+    }
 }
 
 
@@ -254,30 +313,1038 @@ void GraphObj::optimize() {
         }
     }
 
-    void GraphObj::dataMalloc()
+    // Operators whose output is bound to the memory of their input: shape-only
+    // operators and those turned into strided views by optimize().
+    static bool isAliasOp(const Operator &op)
+    {
+        if (op->getOutputs().size() == 1 && op->getOutput()->isView())
+            return true;
+        switch (op->getOpType().underlying())
+        {
+        case OpType::Reshape:
+        case OpType::Flatten:
+        case OpType::Squeeze:
+        case OpType::Unsqueeze:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    // Element-wise operators whose kernels may write over an input.
+    static bool isInplaceOp(const Operator &op)
+    {
+        switch (op->getOpType().underlying())
+        {
+        case OpType::Add:
+        case OpType::Sub:
+        case OpType::Mul:
+        case OpType::Div:
+        case OpType::Relu:
+        case OpType::Clip:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    // Every tensor is placed inside the memory of a root tensor, which is the
+    // only one taking space in the arena. A placement maps a tensor to the
+    // tensor it is placed in and the byte offset inside it. It does not
+    // depend on the order of 'ops'.
+    using Placement =
+        std::unordered_map<TensorObj *, std::pair<TensorObj *, size_t>>;
+
+    static Placement planPlacement(const OpVec &ops)
+    {
+        Placement parent;
+
+        // Outputs of shape-only operators and views reuse the memory of their
+        // input. A bound output keeps its memory: the kernels copy into it.
+        for (const auto &op : ops)
+            if (isAliasOp(op) && (op->getOutput()->isView() ||
+                                  !op->getOutput()->isExternal()))
+                parent[op->getOutput().get()] = {op->getInputs(0).get(), 0};
+
+        // An input of a Concat that feeds nothing else is produced directly
+        // into its slice of the Concat output. Slices are contiguous as long
+        // as all dimensions before the concatenated one are 1.
+        for (const auto &op : ops)
+        {
+            if (op->getOpType() != OpType::Concat)
+                continue;
+            auto output = op->getOutput();
+            auto dims = output->getDims();
+            auto dim = as<ConcatObj>(op)->getDim();
+            if (std::accumulate(dims.begin(), dims.begin() + dim, 1,
+                                std::multiplies<int>()) != 1)
+                continue;
+            size_t sliceOffset = 0;
+            for (const auto &input : op->getInputs())
+            {
+                if (input->getSource() && input->getTargets().size() == 1 &&
+                    !input->isExternal() &&
+                    parent.find(input.get()) == parent.end())
+                    parent[input.get()] = {output.get(), sliceOffset};
+                sliceOffset += input->getBytes();
+            }
+        }
+
+        // Element-wise operators overwrite an input that dies with them.
+        for (const auto &op : ops)
+        {
+            if (!isInplaceOp(op))
+                continue;
+            auto output = op->getOutput();
+            if (output->isExternal() || parent.find(output.get()) != parent.end())
+                continue;
+            for (const auto &input : op->getInputs())
+            {
+                if (input->getSource() && input->getTargets().size() == 1 &&
+                    input->getDType() == output->getDType() &&
+                    input->getBytes() == output->getBytes() &&
+                    input->isContiguous() && !isAliasOp(input->getSource()))
+                {
+                    parent[output.get()] = {input.get(), 0};
+                    break;
+                }
+            }
+        }
+
+        return parent;
+    }
+
+    static TensorObj *findRoot(const Placement &parent, TensorObj *tensor)
+    {
+        auto it = parent.find(tensor);
+        return it == parent.end() ? tensor : findRoot(parent, it->second.first);
+    }
+
+    // The roots allocated and freed at each step of 'ops', see dataMalloc.
+    // Replaying the run, outputs of a step are allocated before the roots it
+    // reads for the last time are freed.
+    struct Liveness
+    {
+        vector<vector<TensorObj *>> born, dead;
+    };
+
+    static Liveness planLiveness(const OpVec &ops, const TensorVec &tensors,
+                                 const Placement &parent)
+    {
+        // A root is live from the first step producing any tensor placed in
+        // it to the last step reading one. Graph inputs and outputs are live
+        // during the whole run.
+        int nSteps = ops.size();
+        std::unordered_map<OperatorObj *, int> step;
+        for (int i = 0; i < nSteps; ++i)
+            step[ops[i].get()] = i;
+        std::unordered_map<TensorObj *, std::pair<int, int>> lifetime;
+        vector<TensorObj *> roots;
+        for (const auto &tensor : tensors)
+        {
+            auto source = tensor->getSource();
+            auto targets = tensor->getTargets();
+            int begin = source ? step.at(source.get()) : -1;
+            int end = (!source || targets.empty()) ? nSteps : -1;
+            for (const auto &target : targets)
+                end = std::max(end, step.at(target.get()));
+
+            auto root = findRoot(parent, tensor.get());
+            auto it = lifetime.find(root);
+            if (it == lifetime.end())
+            {
+                lifetime[root] = {begin, end};
+                roots.emplace_back(root);
+            }
+            else
+            {
+                it->second.first = std::min(it->second.first, begin);
+                it->second.second = std::max(it->second.second, end);
+            }
+        }
+
+        vector<vector<TensorObj *>> born(nSteps + 1), dead(nSteps + 1);
+        for (auto root : roots)
+        {
+            // bound before planning, it takes no space in the arena
+            if (root->isExternal())
+                continue;
+            auto [begin, end] = lifetime[root];
+            born[begin + 1].emplace_back(root);
+            if (end < nSteps)
+                dead[end + 1].emplace_back(root);
+        }
+        return {born, dead};
+    }
+
+    // The most bytes live at once with roots padded to 'alignment', a lower
+    // bound of the arena size.
+    static size_t maxLiveBytes(const Liveness &liveness, size_t alignment)
+    {
+        auto bytes = [&](TensorObj *root)
+        { return (root->getBytes() + alignment - 1) / alignment * alignment; };
+        size_t live = 0, peak = 0;
+        for (size_t i = 0; i < liveness.born.size(); ++i)
+        {
+            for (auto root : liveness.born[i])
+                live += bytes(root);
+            peak = std::max(peak, live);
+            for (auto root : liveness.dead[i])
+                live -= bytes(root);
+        }
+        return peak;
+    }
+
+    namespace
+    {
+        // The arena usage of a graph as the scheduler sees it: roots which
+        // are not live during the whole run, with the operators producing
+        // and reading the tensors placed in them.
+        struct ScheduleProblem
+        {
+            size_t n;
+            vector<vector<int>> preds;
+            vector<size_t> rootBytes;
+            vector<vector<int>> rootUsers;
+            // roots an operator produces into and roots it touches
+            vector<vector<int>> produces, uses;
+            // all roots an operator reads and writes, persistent ones too
+            vector<vector<int>> reads, writes;
+
+            ScheduleProblem(const OpVec &ops)
+                : n(ops.size()), preds(n), produces(n), uses(n), reads(n),
+                  writes(n)
+            {
+                std::unordered_map<OperatorObj *, int> index;
+                for (size_t i = 0; i < n; ++i)
+                    index[ops[i].get()] = i;
+                for (size_t i = 0; i < n; ++i)
+                    for (const auto &pred : ops[i]->getPredecessors())
+                        preds[i].emplace_back(index.at(pred.get()));
+
+                auto parent = planPlacement(ops);
+                std::unordered_map<TensorObj *, int> rootIndex;
+                std::unordered_set<TensorObj *> persistent;
+                for (const auto &op : ops)
+                    for (const auto &tensors : {op->getInputs(), op->getOutputs()})
+                        for (const auto &tensor : tensors)
+                        {
+                            auto root = findRoot(parent, tensor.get());
+                            if (!tensor->getSource() || tensor->getTargets().empty())
+                                persistent.insert(root);
+                            if (rootIndex.emplace(root, rootBytes.size()).second)
+                                rootBytes.emplace_back(root->getBytes());
+                        }
+                rootUsers.resize(rootBytes.size());
+                for (size_t i = 0; i < n; ++i)
+                {
+                    std::set<int> read, written;
+                    for (const auto &tensor : ops[i]->getInputs())
+                        read.insert(rootIndex.at(findRoot(parent, tensor.get())));
+                    for (const auto &tensor : ops[i]->getOutputs())
+                        written.insert(rootIndex.at(findRoot(parent, tensor.get())));
+                    reads[i].assign(read.begin(), read.end());
+                    writes[i].assign(written.begin(), written.end());
+
+                    std::set<int> touched;
+                    for (const auto &tensors : {ops[i]->getInputs(), ops[i]->getOutputs()})
+                        for (const auto &tensor : tensors)
+                        {
+                            auto root = findRoot(parent, tensor.get());
+                            if (persistent.count(root))
+                                continue;
+                            int r = rootIndex.at(root);
+                            touched.insert(r);
+                            if (tensor->getSource().get() == ops[i].get())
+                                produces[i].emplace_back(r);
+                        }
+                    for (int r : touched)
+                    {
+                        uses[i].emplace_back(r);
+                        rootUsers[r].emplace_back(i);
+                    }
+                }
+            }
+
+            // Try every order, by dynamic programming over the set of
+            // operators already run: the bytes live between two steps only
+            // depend on that set.
+            vector<int> exact() const
+            {
+                using Mask = uint32_t;
+                size_t nRoots = rootBytes.size();
+                vector<Mask> predMask(n, 0), rootProducers(nRoots, 0),
+                    rootUserMask(nRoots, 0);
+                for (size_t i = 0; i < n; ++i)
+                {
+                    for (int p : preds[i])
+                        predMask[i] |= Mask(1) << p;
+                    for (int r : produces[i])
+                        rootProducers[r] |= Mask(1) << i;
+                    for (int r : uses[i])
+                        rootUserMask[r] |= Mask(1) << i;
+                }
+                Mask full = (Mask(1) << n) - 1;
+                vector<size_t> best(full + 1, SIZE_MAX);
+                vector<int> last(full + 1, -1);
+                best[0] = 0;
+                for (Mask done = 0; done < full; ++done)
+                {
+                    if (best[done] == SIZE_MAX)
+                        continue;
+                    size_t live = 0;
+                    for (size_t r = 0; r < nRoots; ++r)
+                        if ((rootProducers[r] & done) &&
+                            (rootUserMask[r] & ~done))
+                            live += rootBytes[r];
+                    for (size_t i = 0; i < n; ++i)
+                    {
+                        Mask bit = Mask(1) << i;
+                        if ((done & bit) || (predMask[i] & ~done))
+                            continue;
+                        size_t step = live;
+                        for (int r : produces[i])
+                            if (!(rootProducers[r] & done))
+                                step += rootBytes[r];
+                        size_t peak = std::max(best[done], step);
+                        if (peak < best[done | bit])
+                        {
+                            best[done | bit] = peak;
+                            last[done | bit] = i;
+                        }
+                    }
+                }
+                vector<int> order(n);
+                Mask done = full;
+                for (size_t i = n; i > 0; --i)
+                {
+                    order[i - 1] = last[done];
+                    done &= ~(Mask(1) << order[i - 1]);
+                }
+                return order;
+            }
+
+            // Run the ready operator that brings the peak up the least, then
+            // the one that frees the most, then the earliest in 'ops'.
+            vector<int> greedy() const
+            {
+                vector<int> pending(n), remaining(rootBytes.size());
+                vector<bool> produced(rootBytes.size(), false);
+                vector<vector<int>> succs(n);
+                for (size_t i = 0; i < n; ++i)
+                {
+                    pending[i] = preds[i].size();
+                    for (int p : preds[i])
+                        succs[p].emplace_back(i);
+                }
+                for (size_t r = 0; r < rootBytes.size(); ++r)
+                    remaining[r] = rootUsers[r].size();
+                std::set<int> ready;
+                for (size_t i = 0; i < n; ++i)
+                    if (pending[i] == 0)
+                        ready.insert(i);
+
+                vector<int> order;
+                size_t live = 0;
+                while (!ready.empty())
+                {
+                    int pick = -1;
+                    size_t pickStep = 0;
+                    long long pickDelta = 0;
+                    for (int i : ready)
+                    {
+                        size_t born = 0, freed = 0;
+                        for (int r : produces[i])
+                            if (!produced[r])
+                                born += rootBytes[r];
+                        for (int r : uses[i])
+                            if (remaining[r] == 1)
+                                freed += rootBytes[r];
+                        long long delta = (long long)born - (long long)freed;
+                        if (pick == -1 || live + born < pickStep ||
+                            (live + born == pickStep && delta < pickDelta))
+                        {
+                            pick = i;
+                            pickStep = live + born;
+                            pickDelta = delta;
+                        }
+                    }
+                    ready.erase(pick);
+                    order.emplace_back(pick);
+                    for (int r : produces[pick])
+                        if (!produced[r])
+                        {
+                            produced[r] = true;
+                            live += rootBytes[r];
+                        }
+                    for (int r : uses[pick])
+                        if (--remaining[r] == 0)
+                            live -= rootBytes[r];
+                    for (int s : succs[pick])
+                        if (--pending[s] == 0)
+                            ready.insert(s);
+                }
+                return order;
+            }
+
+            // Run the ready operator reading the most bytes which are still
+            // cached, then the one reading the most recently touched root,
+            // which walks chains depth first. The cache holds the last
+            // 'cacheBytes' bytes touched: a root larger than that, or touched
+            // long ago, is only partly resident.
+            vector<int> locality(size_t cacheBytes) const
+            {
+                vector<int> pending(n);
+                vector<vector<int>> succs(n);
+                for (size_t i = 0; i < n; ++i)
+                {
+                    pending[i] = preds[i].size();
+                    for (int p : preds[i])
+                        succs[p].emplace_back(i);
+                }
+                std::set<int> ready;
+                for (size_t i = 0; i < n; ++i)
+                    if (pending[i] == 0)
+                        ready.insert(i);
+
+                // roots from the most to the least recently touched, with
+                // their resident bytes
+                std::list<std::pair<int, size_t>> cache;
+                vector<std::list<std::pair<int, size_t>>::iterator> cached(
+                    rootBytes.size(), cache.end());
+                vector<size_t> lastTouch(rootBytes.size(), 0);
+                size_t residentBytes = 0;
+                auto touch = [&](int r, size_t time)
+                {
+                    if (cached[r] != cache.end())
+                    {
+                        residentBytes -= cached[r]->second;
+                        cache.erase(cached[r]);
+                    }
+                    size_t bytes = std::min(rootBytes[r], cacheBytes);
+                    cache.emplace_front(r, bytes);
+                    cached[r] = cache.begin();
+                    residentBytes += bytes;
+                    lastTouch[r] = time;
+                    while (residentBytes > cacheBytes)
+                    {
+                        auto &[victim, resident] = cache.back();
+                        size_t excess = residentBytes - cacheBytes;
+                        if (resident > excess)
+                        {
+                            resident -= excess;
+                            residentBytes -= excess;
+                            break;
+                        }
+                        residentBytes -= resident;
+                        cached[victim] = cache.end();
+                        cache.pop_back();
+                    }
+                };
+
+                vector<int> order;
+                while (!ready.empty())
+                {
+                    int pick = -1;
+                    size_t pickHit = 0, pickRecent = 0;
+                    for (int i : ready)
+                    {
+                        size_t hit = 0, recent = 0;
+                        for (int r : reads[i])
+                        {
+                            if (cached[r] != cache.end())
+                                hit += cached[r]->second;
+                            recent = std::max(recent, lastTouch[r]);
+                        }
+                        if (pick == -1 || hit > pickHit ||
+                            (hit == pickHit && recent > pickRecent))
+                        {
+                            pick = i;
+                            pickHit = hit;
+                            pickRecent = recent;
+                        }
+                    }
+                    ready.erase(pick);
+                    order.emplace_back(pick);
+                    for (int r : reads[pick])
+                        touch(r, order.size());
+                    for (int r : writes[pick])
+                        touch(r, order.size());
+                    for (int s : succs[pick])
+                        if (--pending[s] == 0)
+                            ready.insert(s);
+                }
+                return order;
+            }
+        };
+
+        // Bytes the Locality schedule assumes stay cached between two
+        // operators, the L2 size of current server cores.
+        constexpr size_t localityCacheBytes = 2 << 20;
+    } // namespace
+
+    void GraphObj::schedule()
+    {
+        IT_ASSERT(topo_sort() == true);
+        if (scheduleMode == ScheduleMode::Topological || ops.size() < 2)
+            return;
+
+        ScheduleProblem problem(ops);
+        vector<int> order;
+        if (scheduleMode == ScheduleMode::Locality)
+            order = problem.locality(localityCacheBytes);
+        else
+            order = ops.size() <= exactScheduleLimit ? problem.exact()
+                                                      : problem.greedy();
+        IT_ASSERT(order.size() == ops.size());
+        OpVec scheduled;
+        scheduled.reserve(ops.size());
+        for (int i : order)
+            scheduled.emplace_back(ops[i]);
+        ops = std::move(scheduled);
+    }
+
+    // Operators cheap enough to run twice rather than keeping their output
+    // alive, and the floating-point operations they take per output element.
+    static optional<int> recomputeFlops(const Operator &op)
+    {
+        if (op->getOutputs().size() != 1 || isAliasOp(op))
+            return std::nullopt;
+        switch (op->getOpType().underlying())
+        {
+        case OpType::Transpose:
+        case OpType::Cast:
+            return 0;
+        case OpType::Add:
+        case OpType::Sub:
+        case OpType::Mul:
+        case OpType::Div:
+        case OpType::Relu:
+            return 1;
+        case OpType::Clip:
+            return 2;
+        default:
+            return std::nullopt;
+        }
+    }
+
+    Operator GraphObj::recompute(const Tensor &tensor, const OpVec &consumers,
+                                 size_t pos)
+    {
+        auto source = tensor->getSource();
+        auto copy = source->clone(source->getInputs(),
+                                  {addTensor(tensor->getDims(), tensor->getDType())});
+        auto output = copy->getOutput();
+        output->setSource(copy);
+        for (const auto &input : copy->getInputs())
+        {
+            input->addTarget(copy);
+            if (auto pred = input->getSource())
+            {
+                pred->addSuccessors(copy);
+                copy->addPredecessors(pred);
+            }
+        }
+        for (const auto &consumer : consumers)
+        {
+            consumer->replaceInput(tensor, output);
+            tensor->removeTarget(consumer);
+            source->removeSuccessors(consumer);
+            consumer->removePredecessors(source);
+            for (const auto &input : consumer->getInputs())
+            {
+                if (input != output)
+                    continue;
+                output->addTarget(consumer);
+                copy->addSuccessors(consumer);
+                consumer->addPredecessors(copy);
+            }
+        }
+        ops.insert(ops.begin() + pos, copy);
+        return copy;
+    }
+
+    void GraphObj::undoRecompute(const Operator &copy, const Tensor &tensor,
+                                 const OpVec &consumers)
+    {
+        auto source = tensor->getSource();
+        auto output = copy->getOutput();
+        for (const auto &consumer : consumers)
+        {
+            consumer->replaceInput(output, tensor);
+            consumer->removePredecessors(copy);
+            for (const auto &input : consumer->getInputs())
+            {
+                if (input != tensor)
+                    continue;
+                tensor->addTarget(consumer);
+                source->addSuccessors(consumer);
+                consumer->addPredecessors(source);
+            }
+        }
+        for (const auto &input : copy->getInputs())
+        {
+            input->removeTarget(copy);
+            if (auto pred = input->getSource())
+                pred->removeSuccessors(copy);
+        }
+        removeOperator(copy);
+        removeTensor(output);
+    }
+
+    namespace
+    {
+        // The bytes live at each step of a Liveness as maxLiveBytes counts
+        // them, and the steps each root is live, for estimating the peak of
+        // a slightly changed run without planning it again. The most bytes
+        // live over a range of steps is read from a sparse table.
+        struct LiveProfile
+        {
+            size_t alignment;
+            // Bytes live at each step, and bytes of the roots freed after it.
+            vector<size_t> live, freed;
+            // Root -> first and last step it is live.
+            std::unordered_map<TensorObj *, std::pair<int, int>> span;
+            // table[k][i] is the most bytes live over steps [i, i + 2^k).
+            vector<vector<size_t>> table;
+
+            LiveProfile(const Liveness &liveness, size_t alignment)
+                : alignment(alignment)
+            {
+                int n = liveness.born.size();
+                live.resize(n);
+                freed.resize(n);
+                size_t bytes = 0;
+                for (int i = 0; i < n; ++i)
+                {
+                    for (auto root : liveness.born[i])
+                    {
+                        bytes += padded(root);
+                        span[root] = {i, n - 1};
+                    }
+                    live[i] = bytes;
+                    for (auto root : liveness.dead[i])
+                    {
+                        freed[i] += padded(root);
+                        span[root].second = i;
+                    }
+                    bytes -= freed[i];
+                }
+                table.emplace_back(live);
+                for (int w = 1; 2 * w <= n; w *= 2)
+                {
+                    const auto &prev = table.back();
+                    vector<size_t> next(n - 2 * w + 1);
+                    for (size_t i = 0; i < next.size(); ++i)
+                        next[i] = std::max(prev[i], prev[i + w]);
+                    table.emplace_back(std::move(next));
+                }
+            }
+
+            size_t padded(TensorObj *root) const
+            {
+                return (root->getBytes() + alignment - 1) / alignment *
+                       alignment;
+            }
+
+            // The most bytes live over steps [lo, hi], 0 if it is empty.
+            size_t peak(int lo, int hi) const
+            {
+                if (lo > hi)
+                    return 0;
+                int k = 0;
+                while ((2 << k) <= hi - lo + 1)
+                    ++k;
+                return std::max(table[k][lo], table[k][hi - (1 << k) + 1]);
+            }
+
+            // The most bytes live if 'bytes' were added over steps [lo, hi]
+            // for each {lo, hi, bytes} of 'changes'.
+            size_t peak(const vector<std::tuple<int, int, long long>> &changes) const
+            {
+                vector<std::pair<int, long long>> events;
+                for (auto [lo, hi, bytes] : changes)
+                    if (lo <= hi)
+                    {
+                        events.emplace_back(lo, bytes);
+                        events.emplace_back(hi + 1, -bytes);
+                    }
+                std::sort(events.begin(), events.end());
+                int begin = 0;
+                long long delta = 0;
+                size_t ret = 0;
+                for (auto [at, bytes] : events)
+                {
+                    if (begin < at)
+                        ret = std::max(ret, size_t(peak(begin, at - 1) + delta));
+                    delta += bytes;
+                    begin = at;
+                }
+                return std::max(ret, peak(begin, int(live.size()) - 1));
+            }
+        };
+
+        // Copies tried per round of rematerialize, best estimate first,
+        // before giving up on lowering the peak.
+        constexpr size_t rematerializeTries = 4;
+    } // namespace
+
+    size_t GraphObj::rematerialize(size_t budget)
+    {
+        IT_ASSERT(topo_sort() == true);
+        auto peakOf = [&]()
+        {
+            return maxLiveBytes(
+                planLiveness(ops, tensors, planPlacement(ops)),
+                allocator.getAlignment());
+        };
+        size_t peak = peakOf(), initialPeak = peak;
+        size_t copies = 0, flops = 0, rereadBytes = 0;
+
+        // A candidate copies a cheap tensor read by several operators for
+        // its late readers: early ones keep it, late ones read a copy
+        // computed right before the first of them. Each round estimates the
+        // peak after every candidate from the live-bytes profile of the
+        // current run, then plans the best few for real and keeps the first
+        // lowering the peak.
+        struct Candidate
+        {
+            size_t estimate;
+            Tensor tensor;
+            OpVec consumers;
+            size_t pos;
+        };
+        for (size_t round = 0; peak > budget && round < maxRematerializeRounds;
+             ++round)
+        {
+            std::unordered_map<OperatorObj *, int> step;
+            for (size_t i = 0; i < ops.size(); ++i)
+                step[ops[i].get()] = i;
+            auto parent = planPlacement(ops);
+            LiveProfile profile(planLiveness(ops, tensors, parent),
+                                allocator.getAlignment());
+            // The last step reading each tensor.
+            auto lastRead = [&](TensorObj *tensor)
+            {
+                int end = tensor->getSource() && !tensor->getTargets().empty()
+                              ? -1
+                              : int(ops.size());
+                for (const auto &target : tensor->getTargets())
+                    end = std::max(end, step.at(target.get()));
+                return end;
+            };
+            // The tensors placed in each root, and for each tensor those
+            // placed in it through one of its readers, such as a Reshape of
+            // it, with the step of that reader. These follow the copy when
+            // the reader is a late one.
+            struct Placed
+            {
+                int readerStep, lastRead;
+                TensorObj *tensor;
+            };
+            std::unordered_map<TensorObj *, vector<TensorObj *>> members;
+            std::unordered_map<TensorObj *, vector<Placed>> placedVia;
+            for (const auto &tensor : tensors)
+            {
+                members[findRoot(parent, tensor.get())].emplace_back(
+                    tensor.get());
+                int read = lastRead(tensor.get());
+                TensorObj *child = tensor.get();
+                for (auto it = parent.find(child); it != parent.end();
+                     child = it->second.first, it = parent.find(child))
+                    if (auto reader = child->getSource())
+                        placedVia[it->second.first].push_back(
+                            {step.at(reader.get()), read, tensor.get()});
+            }
+
+            vector<Candidate> candidates;
+            for (const auto &tensor : tensors)
+            {
+                auto source = tensor->getSource();
+                auto root = findRoot(parent, tensor.get());
+                auto span = profile.span.find(root);
+                if (!source || !recomputeFlops(source) ||
+                    span == profile.span.end())
+                    continue;
+                // The last step reading the other tensors placed in the
+                // root, which keep it live whichever readers are copied.
+                const auto &via = placedVia[tensor.get()];
+                std::unordered_set<TensorObj *> followers{tensor.get()};
+                for (const auto &placed : via)
+                    followers.insert(placed.tensor);
+                int others = -1;
+                for (auto member : members.at(root))
+                    if (!followers.count(member))
+                        others = std::max(others, lastRead(member));
+                OpVec readers;
+                for (const auto &target : tensor->getTargets())
+                    if (std::find(readers.begin(), readers.end(), target) ==
+                        readers.end())
+                        readers.emplace_back(target);
+                std::sort(readers.begin(), readers.end(),
+                          [&](const Operator &a, const Operator &b)
+                          { return step.at(a.get()) < step.at(b.get()); });
+
+                // Roots the copy reads, with the last step they are live.
+                vector<std::pair<TensorObj *, int>> inputs;
+                for (const auto &input : source->getInputs())
+                {
+                    auto inputRoot = findRoot(parent, input.get());
+                    auto it = profile.span.find(inputRoot);
+                    if (it != profile.span.end() &&
+                        std::none_of(inputs.begin(), inputs.end(),
+                                     [&](const auto &p)
+                                     { return p.first == inputRoot; }))
+                        inputs.emplace_back(inputRoot, it->second.second);
+                }
+
+                // The root of the output of 'reader' if it would run in
+                // place over 'input' once nothing else reads 'input', see
+                // planPlacement.
+                auto inPlaceOver = [&](const Operator &reader,
+                                       const Tensor &input) -> TensorObj *
+                {
+                    auto output = reader->getOutput();
+                    auto targets = tensor->getTargets();
+                    if (!isInplaceOp(reader) || output->isExternal() ||
+                        parent.count(output.get()) ||
+                        !profile.span.count(output.get()) ||
+                        std::count(targets.begin(), targets.end(), reader) != 1 ||
+                        !(input->getDType() == output->getDType()) ||
+                        input->getBytes() != output->getBytes() ||
+                        !input->isContiguous())
+                        return nullptr;
+                    return output.get();
+                };
+
+                int end = span->second.second;
+                long long rootBytes = profile.padded(root),
+                          copyBytes = profile.padded(tensor.get());
+                for (size_t j = 1; j < readers.size(); ++j)
+                {
+                    // Steps are those of the current run, the copy runs
+                    // between steps pos and pos + 1. The root is freed after
+                    // step 'keep' rather than 'end' and the copy is live
+                    // from pos on. Inputs of the copy freed before pos are
+                    // kept until it runs. With a single reader left, the
+                    // tensor or the copy may be overwritten in place by it.
+                    int early = step.at(readers[j - 1].get());
+                    int pos = step.at(readers[j].get());
+                    int keep = std::max(others, early),
+                        copyEnd = step.at(readers.back().get());
+                    for (const auto &placed : via)
+                        if (placed.readerStep < pos)
+                            keep = std::max(keep, placed.lastRead);
+                        else
+                            copyEnd = std::max(copyEnd, placed.lastRead);
+                    if (++keep > pos)
+                        continue;
+                    ++copyEnd;
+                    vector<std::tuple<int, int, long long>> changes;
+                    long long during =
+                        profile.live[pos] - profile.freed[pos] + copyBytes;
+                    if (auto output = j == 1 ? inPlaceOver(readers[0], tensor)
+                                             : nullptr)
+                    {
+                        auto [begin, outputEnd] = profile.span.at(output);
+                        changes.emplace_back(begin, outputEnd,
+                                             -profile.padded(output));
+                        if (outputEnd > pos)
+                            during -= profile.padded(output);
+                        keep = std::max(keep, outputEnd);
+                    }
+                    if (auto output = j + 1 == readers.size()
+                                          ? inPlaceOver(readers[j], tensor)
+                                          : nullptr)
+                    {
+                        auto [begin, outputEnd] = profile.span.at(output);
+                        changes.emplace_back(begin, outputEnd,
+                                             -profile.padded(output));
+                        copyEnd = std::max(copyEnd, outputEnd);
+                    }
+                    changes.emplace_back(keep + 1, end, -rootBytes);
+                    changes.emplace_back(end + 1, keep, rootBytes);
+                    changes.emplace_back(pos + 1, copyEnd, copyBytes);
+                    if (keep <= pos)
+                        during -= rootBytes;
+                    for (auto [inputRoot, inputEnd] : inputs)
+                        if (inputEnd <= pos)
+                        {
+                            changes.emplace_back(inputEnd + 1, pos,
+                                                 profile.padded(inputRoot));
+                            during += profile.padded(inputRoot);
+                        }
+                    size_t estimate =
+                        std::max(size_t(during), profile.peak(changes));
+                    if (estimate < peak)
+                        candidates.push_back(
+                            {estimate, tensor,
+                             OpVec(readers.begin() + j, readers.end()),
+                             size_t(pos)});
+                }
+            }
+            std::stable_sort(candidates.begin(), candidates.end(),
+                             [](const Candidate &a, const Candidate &b)
+                             { return a.estimate < b.estimate; });
+
+            bool lowered = false;
+            for (size_t k = 0;
+                 k < std::min(candidates.size(), rematerializeTries); ++k)
+            {
+                const auto &[estimate, tensor, consumers, pos] = candidates[k];
+                auto copy = recompute(tensor, consumers, pos);
+                size_t newPeak = peakOf();
+                if (newPeak >= peak)
+                {
+                    undoRecompute(copy, tensor, consumers);
+                    continue;
+                }
+                auto source = tensor->getSource();
+                peak = newPeak;
+                copies++;
+                flops += *recomputeFlops(source) * tensor->size();
+                for (const auto &input : source->getInputs())
+                    rereadBytes += input->getBytes();
+                lowered = true;
+                break;
+            }
+            if (!lowered)
+                break;
+        }
+
+        if (copies > 0 || peak > budget)
+            std::cout << "Rematerialization: " << copies
+                      << " recomputed tensors, " << flops << " extra FLOPs, "
+                      << rereadBytes << " bytes read again, peak live "
+                      << initialPeak << " -> " << peak << " bytes (budget "
+                      << budget << ")" << std::endl;
+        return peak;
+    }
+
+    void GraphObj::dataMalloc(size_t budget)
     {
         // topological sorting first
         IT_ASSERT(topo_sort() == true);
+        schedule();
+        if (budget > 0)
+            rematerialize(budget);
 
         // =================================== 作业 ===================================
         // TODO：利用 allocator 给计算图分配内存
         // HINT: 获取分配好的内存指针后，可以调用 tensor 的 setDataBlob 函数给 tensor 绑定内存
         // =================================== 作业 ===================================
-        size_t sizeTensorPtr = this->tensors.size();
-        std::vector<size_t> offset;
-        // getBytes()
-        for(const auto &tensor:tensors){
-            offset.push_back(allocator.alloc(tensor->getBytes()));
+        auto parent = planPlacement(ops);
+
+        int nSteps = ops.size();
+        auto [born, dead] = planLiveness(ops, tensors, parent);
+        std::unordered_map<TensorObj *, size_t> offset;
+        for (int i = 0; i <= nSteps; ++i)
+        {
+            allocator.setTraceTag(i > 0 ? ops[i - 1]->getGuid() : 0);
+            for (auto root : born[i])
+                offset[root] = allocator.alloc(root->getBytes());
+            for (auto root : dead[i])
+                allocator.free(offset[root], root->getBytes());
         }
+
+        // (root, byte offset in the root) of a tensor
+        std::function<std::pair<TensorObj *, size_t>(TensorObj *)> locate =
+            [&](TensorObj *tensor)
+        {
+            auto it = parent.find(tensor);
+            if (it == parent.end())
+                return std::make_pair(tensor, size_t(0));
+            auto ret = locate(it->second.first);
+            ret.second += it->second.second;
+            return ret;
+        };
+
+        // Tensors placed in a root bound before planning, such as a weight
+        // mapped from a model file, point into its memory and keep it alive.
+        // The others keep the arena alive in the same way.
         auto dptr = this->allocator.getPtr();
-        for(size_t i = 0 ;i<sizeTensorPtr;++i){
-            auto rptr = reinterpret_cast<char*>(dptr) + offset[i];
-            this->tensors[i] -> setDataBlob(make_ref<BlobObj>(this->runtime, (void*)rptr));
+        allocated = true;
+        arenaOffset.clear();
+        placedIn.clear();
+        for (const auto &tensor : tensors)
+        {
+            auto [root, rootOffset] = locate(tensor.get());
+            if (root->isExternal())
+            {
+                auto &placed = placedIn[root];
+                if (root != tensor.get())
+                    placed.emplace_back(tensor, rootOffset);
+                if (!root->getDataBlob())
+                    continue; // bound later, see bind
+            }
+            if (root == tensor.get() && root->isExternal())
+                continue;
+            if (!root->isExternal())
+                arenaOffset[tensor.get()] = offset.at(root) + rootOffset;
+            auto base = root->isExternal() ? root->getRawDataPtr<char *>()
+                                        : reinterpret_cast<char *>(dptr) +
+                                              offset.at(root);
+            tensor->setDataBlob(make_ref<BlobObj>(
+                this->runtime, (void *)(base + rootOffset),
+                root->isExternal() ? Ref<void>(root->getDataBlob())
+                                   : allocator.getArena()));
         }
-        
+
         allocator.info();
+    }
+
+    GraphObj::GraphObj(Runtime runtime, const OpVec &ops)
+        : GraphObj(runtime)
+    {
+        std::unordered_map<UidBaseType, Tensor> clones;
+        auto cloneAll = [&](const TensorVec &tensors)
+        {
+            TensorVec ret;
+            for (const auto &tensor : tensors)
+            {
+                auto &clone = clones[tensor->getFuid()];
+                if (!clone)
+                    clone = addTensor(tensor->clone());
+                ret.emplace_back(clone);
+            }
+            return ret;
+        };
+        for (const auto &op : ops)
+        {
+            auto inputs = cloneAll(op->getInputs());
+            auto outputs = cloneAll(op->getOutputs());
+            addOperatorAndConnect(op->clone(inputs, outputs));
+        }
+        sorted = true;
+    }
 
+    void GraphObj::setExternal(const Tensor &tensor)
+    {
+        IT_ASSERT(std::find(tensors.begin(), tensors.end(), tensor) !=
+                      tensors.end(),
+                  "Tensor " + std::to_string(tensor->getGuid()) +
+                      " is not in the graph");
+        IT_ASSERT(!tensor->getSource() || tensor->getTargets().empty(),
+                  "Only graph inputs and outputs can be bound");
+        IT_ASSERT(!tensor->isView(), "Views cannot be bound");
+        IT_ASSERT(!allocated || tensor->isExternal(),
+                  "Tensors are planned already, call setExternal before "
+                  "dataMalloc");
+        tensor->external = true;
+    }
 
+    void GraphObj::bind(const Tensor &tensor, void *ptr, Ref<void> owner)
+    {
+        setExternal(tensor);
+        auto blob = make_ref<BlobObj>(runtime, ptr, owner);
+        tensor->setExternalBlob(blob);
+        auto it = placedIn.find(tensor.get());
+        if (it == placedIn.end())
+            return;
+        for (const auto &[placed, offset] : it->second)
+            placed->setDataBlob(
+                make_ref<BlobObj>(runtime, static_cast<char *>(ptr) + offset,
+                                  blob));
     }
 
     Tensor GraphObj::addTensor(Shape dim, DataType dtype)
@@ -0,0 +1,282 @@
+#include "core/jit.h"
+#include "core/codegen.h"
+#include "operators/fused.h"
+#include <cstdio>
+#include <cstdlib>
+#include <dlfcn.h>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace infini
+{
+    namespace
+    {
+        bool isFusible(const Operator &op)
+        {
+            switch (op->getOpType().underlying())
+            {
+            case OpType::Add:
+            case OpType::Sub:
+            case OpType::Mul:
+            case OpType::Div:
+            case OpType::Relu:
+            case OpType::Clip:
+                break;
+            default:
+                return false;
+            }
+            auto output = op->getOutput();
+            if (output->isView() || output->getDType() == DataType::Bool)
+                return false;
+            for (const auto &input : op->getInputs())
+                if (!(input->getDType() == output->getDType()))
+                    return false;
+            return true;
+        }
+
+        // FNV-1a, which unlike std::hash is the same in every process.
+        uint64_t hashOf(const string &text)
+        {
+            uint64_t hash = 0xcbf29ce484222325ull;
+            for (unsigned char c : text)
+                hash = (hash ^ c) * 0x100000001b3ull;
+            return hash;
+        }
+
+        // What -march=native resolves to: the identity and features of the
+        // first processor in /proc/cpuinfo, empty if it is not there.
+        const string &hostCpu()
+        {
+            static const string cpu = []()
+            {
+                string ret, line;
+                std::ifstream file("/proc/cpuinfo");
+                while (std::getline(file, line) && !line.empty())
+                {
+                    for (auto field : {"vendor_id", "cpu family", "model",
+                                       "flags", "Features", "CPU part"})
+                        if (line.rfind(field, 0) == 0)
+                            ret += line + "\n";
+                }
+                return ret;
+            }();
+            return cpu;
+        }
+
+        // Creates 'dir' readable by this user only, or checks that it is
+        // owned by this user and not open to others, since every shared
+        // object in it gets loaded.
+        void prepareCacheDir(const string &dir)
+        {
+            auto parent = std::filesystem::path(dir).parent_path();
+            if (!parent.empty())
+                std::filesystem::create_directories(parent);
+            if (mkdir(dir.c_str(), 0700) == 0)
+                return;
+            struct stat info;
+            IT_ASSERT(lstat(dir.c_str(), &info) == 0 && S_ISDIR(info.st_mode),
+                      "Failed to create the JIT cache " + dir);
+            IT_ASSERT(info.st_uid == geteuid(),
+                      "The JIT cache " + dir + " belongs to another user");
+            if ((info.st_mode & 077) != 0)
+                IT_ASSERT(chmod(dir.c_str(), 0700) == 0,
+                          "Failed to restrict the JIT cache " + dir);
+        }
+
+        // Shared objects loaded by this process, by path. Compilation is
+        // serialized by the same lock.
+        std::mutex cacheLock;
+        std::unordered_map<string, Ref<void>> loaded;
+
+        Ref<void> load(const string &path)
+        {
+            auto it = loaded.find(path);
+            if (it != loaded.end())
+                return it->second;
+            auto handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+            IT_ASSERT(handle != nullptr, "Failed to load " + path);
+            Ref<void> library(handle, [](void *handle)
+                              { dlclose(handle); });
+            loaded.emplace(path, library);
+            return library;
+        }
+
+        // The source of a region: one loop nest over the output, computing
+        // each operator as a local and storing only the last.
+        string generate(const OpVec &ops, const TensorVec &inputs,
+                        const string &description)
+        {
+            auto output = ops.back()->getOutput();
+            auto dims = output->getDims();
+            auto type = cTypeOf(output->getDType());
+            std::ostringstream os;
+            os << "// " << description << " over " << vecToString(dims)
+               << "\n#include <algorithm>\n#include <cstddef>\n"
+               << "#include <cstdint>\n\n"
+               << "extern \"C\" void fused(const void *const *in, void *out)\n"
+               << "{\n";
+            vector<LoopOperand> operands{{"y", output->getStride()}};
+            std::unordered_map<TensorObj *, string> names;
+            for (size_t k = 0; k < inputs.size(); ++k)
+            {
+                auto name = "x" + std::to_string(k);
+                os << "    auto " << name << " = static_cast<const " << type
+                   << " *>(in[" << k << "]);\n";
+                operands.push_back({name, broadcastStride(inputs[k], dims)});
+                names[inputs[k].get()] = "$" + std::to_string(k + 1);
+            }
+            os << "    auto y = static_cast<" << type << " *>(out);\n";
+
+            // Locals are named by position, not by guid, so the same region
+            // of another graph has the same source and hits the cache.
+            vector<string> lets;
+            string expr;
+            for (const auto &op : ops)
+            {
+                vector<string> args;
+                for (const auto &input : op->getInputs())
+                    args.emplace_back(names.at(input.get()));
+                expr = elementExpr(op, args);
+                if (op == ops.back())
+                    break;
+                auto name = "v" + std::to_string(lets.size());
+                lets.emplace_back("const " + type + " " + name + " = " + expr +
+                                  ";");
+                names[op->getOutput().get()] = name;
+            }
+            emitLoops(os, dims, operands, expr, lets, 4);
+            os << "}\n";
+            return os.str();
+        }
+
+        FusedElementWiseObj::Function compile(const string &source,
+                                              const JitOptions &options,
+                                              Ref<void> &library)
+        {
+            // The host is part of the key: code built for another CPU, e.g.
+            // with -march=native, may not run on this one.
+            std::ostringstream key;
+            key << std::hex << std::setw(16) << std::setfill('0')
+                << hashOf(source + "\n" + options.compiler + " " +
+                          options.flags + "\n" + hostCpu());
+            auto base = options.cacheDir + "/" + key.str();
+            auto path = base + ".so";
+
+            std::lock_guard<std::mutex> guard(cacheLock);
+            prepareCacheDir(options.cacheDir);
+            if (!std::filesystem::exists(path))
+            {
+                // Built under a name of this process and renamed, so other
+                // processes never load a partly written file.
+                auto building = base + "." + std::to_string(getpid()) + ".so";
+                compileCpp(source, building, options.compiler, options.flags);
+                std::rename((building + ".cc").c_str(), (base + ".cc").c_str());
+                int status = std::rename(building.c_str(), path.c_str());
+                IT_ASSERT(status == 0, "Failed to move " + building);
+            }
+            library = load(path);
+            auto function = reinterpret_cast<FusedElementWiseObj::Function>(
+                dlsym(library.get(), "fused"));
+            IT_ASSERT(function != nullptr, path + " has no fused function");
+            return function;
+        }
+    } // namespace
+
+    string defaultJitCacheDir()
+    {
+        if (auto dir = std::getenv("INFINITENSOR_JIT_CACHE"))
+            return dir;
+        if (auto dir = std::getenv("XDG_CACHE_HOME"); dir && *dir)
+            return string(dir) + "/infinitensor-jit";
+        if (auto dir = std::getenv("HOME"); dir && *dir)
+            return string(dir) + "/.cache/infinitensor-jit";
+        return "/tmp/infinitensor-jit-" + std::to_string(geteuid());
+    }
+
+    size_t fuseElementWise(const Graph &graph, const JitOptions &options)
+    {
+        IT_ASSERT(graph->topo_sort(), "The graph has a cycle");
+        // Regions grow along the sorted operators: an operator joins every
+        // region whose last operator produces one of its inputs for it alone.
+        vector<OpVec> regions;
+        std::unordered_map<OperatorObj *, size_t> regionOf;
+        for (const auto &op : graph->getOperators())
+        {
+            if (!isFusible(op))
+                continue;
+            vector<size_t> joined;
+            for (const auto &input : op->getInputs())
+            {
+                auto source = input->getSource();
+                if (!source || !regionOf.count(source.get()) ||
+                    input->isExternal())
+                    continue;
+                bool only = true;
+                for (const auto &target : input->getTargets())
+                    only = only && target == op;
+                auto r = regionOf.at(source.get());
+                if (only && std::find(joined.begin(), joined.end(), r) ==
+                                joined.end())
+                    joined.emplace_back(r);
+            }
+            if (joined.empty())
+            {
+                joined.emplace_back(regions.size());
+                regions.emplace_back();
+            }
+            // Regions joined by 'op' are independent, so appending one after
+            // the other keeps them sorted.
+            auto &region = regions[joined[0]];
+            for (size_t i = 1; i < joined.size(); ++i)
+            {
+                for (const auto &other : regions[joined[i]])
+                {
+                    region.emplace_back(other);
+                    regionOf[other.get()] = joined[0];
+                }
+                regions[joined[i]].clear();
+            }
+            region.emplace_back(op);
+            regionOf[op.get()] = joined[0];
+        }
+
+        size_t fused = 0;
+        for (const auto &ops : regions)
+        {
+            if (ops.size() < 2)
+                continue;
+            std::unordered_set<TensorObj *> produced;
+            string description;
+            for (const auto &op : ops)
+            {
+                produced.insert(op->getOutput().get());
+                description += (description.empty() ? "" : "+") +
+                               string(op->getOpType().toString());
+            }
+            TensorVec inputs;
+            for (const auto &op : ops)
+                for (const auto &input : op->getInputs())
+                    if (!produced.count(input.get()) &&
+                        std::find(inputs.begin(), inputs.end(), input) ==
+                            inputs.end())
+                        inputs.emplace_back(input);
+            auto output = ops.back()->getOutput();
+            IT_ASSERT(!output->getDataBlob(),
+                      "Call fuseElementWise before dataMalloc");
+
+            Ref<void> library;
+            auto function = compile(generate(ops, inputs, description),
+                                    options, library);
+            graph->replaceOperators(
+                ops, make_ref<FusedElementWiseObj>(nullptr, inputs, output,
+                                                   description, function,
+                                                   library));
+            ++fused;
+        }
+        return fused;
+    }
+} // namespace infini
@@ -0,0 +1,363 @@
+#include "core/model_file.h"
+#include "operators/concat.h"
+#include "operators/element_wise.h"
+#include "operators/matmul.h"
+#include "operators/reshape.h"
+#include "operators/transpose.h"
+#include "operators/unary.h"
+#include <fcntl.h>
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace infini
+{
+    namespace
+    {
+        constexpr char magic[8] = {'I', 'T', 'M', 'O', 'D', 'E', 'L', '\0'};
+        constexpr uint32_t version = 1;
+        constexpr size_t weightAlignment = 64;
+
+        // Values are written and read in host order, and weights are used
+        // straight from the mapping, so the host must match the file.
+        static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__,
+                      "Model files are little-endian, big-endian hosts are "
+                      "not supported");
+
+        // The attributes of an operator, flattened.
+        struct Attributes
+        {
+            vector<int64_t> ints;
+            vector<float> floats;
+        };
+
+        Attributes getAttributes(const Operator &op)
+        {
+            Attributes attrs;
+            auto &ints = attrs.ints;
+            switch (op->getOpType().underlying())
+            {
+            case OpType::Concat:
+                ints = {as<ConcatObj>(op)->getDim()};
+                break;
+            case OpType::MatMul:
+                ints = {as<MatmulObj>(op)->getTransA(),
+                        as<MatmulObj>(op)->getTransB()};
+                break;
+            case OpType::Transpose:
+                for (auto i : as<TransposeObj>(op)->getPermute())
+                    ints.emplace_back(i);
+                break;
+            case OpType::Reshape:
+                for (auto i : as<ReshapeObj>(op)->getShape())
+                    ints.emplace_back(i);
+                break;
+            case OpType::Flatten:
+                ints = {as<FlattenObj>(op)->getAxis()};
+                break;
+            case OpType::Squeeze:
+                for (auto i : as<SqueezeObj>(op)->getAxes())
+                    ints.emplace_back(i);
+                break;
+            case OpType::Unsqueeze:
+                for (auto i : as<UnsqueezeObj>(op)->getAxes())
+                    ints.emplace_back(i);
+                break;
+            case OpType::Cast:
+                ints = {int64_t(as<CastObj>(op)->getType())};
+                break;
+            case OpType::Clip:
+            {
+                auto clip = as<ClipObj>(op);
+                ints = {clip->getMin().has_value(), clip->getMax().has_value()};
+                attrs.floats = {clip->getMin().value_or(0),
+                                clip->getMax().value_or(0)};
+                break;
+            }
+            case OpType::Add:
+            case OpType::Sub:
+            case OpType::Mul:
+            case OpType::Div:
+            case OpType::Relu:
+                break;
+            default:
+                IT_TODO_HALT_MSG(string("Cannot save ") +
+                                 op->getOpType().toString());
+            }
+            return attrs;
+        }
+
+        void addOperator(const Graph &g, OpType type, const TensorVec &in,
+                         const TensorVec &out, const Attributes &attrs)
+        {
+            const auto &ints = attrs.ints;
+            auto intsAs = [&]()
+            { return vector<int>(ints.begin(), ints.end()); };
+            auto check = [&](size_t nIn, size_t nOut, size_t nInts)
+            {
+                IT_ASSERT((nIn == 0 || in.size() == nIn) && out.size() == nOut &&
+                              (nInts == size_t(-1) || ints.size() == nInts),
+                          string("Malformed ") + type.toString());
+            };
+            switch (type.underlying())
+            {
+            case OpType::Concat:
+                check(0, 1, 1);
+                g->addOpWithOutputs<ConcatObj>(in, out[0], ints[0]);
+                break;
+            case OpType::MatMul:
+                check(2, 1, 2);
+                g->addOpWithOutputs<MatmulObj>(in[0], in[1], out[0], ints[0],
+                                               ints[1]);
+                break;
+            case OpType::Transpose:
+                check(1, 1, -1);
+                g->addOpWithOutputs<TransposeObj>(in[0], out[0], intsAs());
+                break;
+            case OpType::Reshape:
+                check(1, 1, -1);
+                g->addOpWithOutputs<ReshapeObj>(in[0], out[0], intsAs());
+                break;
+            case OpType::Flatten:
+                check(1, 1, 1);
+                g->addOpWithOutputs<FlattenObj>(in[0], out[0], ints[0]);
+                break;
+            case OpType::Squeeze:
+                check(1, 1, -1);
+                g->addOpWithOutputs<SqueezeObj>(in[0], out[0], intsAs());
+                break;
+            case OpType::Unsqueeze:
+                check(1, 1, -1);
+                g->addOpWithOutputs<UnsqueezeObj>(in[0], out[0], intsAs());
+                break;
+            case OpType::Cast:
+                check(1, 1, 1);
+                g->addOpWithOutputs<CastObj>(in[0], out[0], CastType(ints[0]));
+                break;
+            case OpType::Clip:
+            {
+                check(1, 1, 2);
+                IT_ASSERT(attrs.floats.size() == 2, "Malformed Clip");
+                auto bound = [&](int i)
+                {
+                    return ints[i] ? std::optional<float>(attrs.floats[i])
+                                   : std::nullopt;
+                };
+                g->addOpWithOutputs<ClipObj>(in[0], out[0], bound(0), bound(1));
+                break;
+            }
+#define CASE_ELEMENT_WISE(prefix)                                      \
+    case OpType::prefix:                                               \
+        check(2, 1, 0);                                                \
+        g->addOpWithOutputs<prefix##Obj>(in[0], in[1], out[0]);        \
+        break;
+                CASE_ELEMENT_WISE(Add)
+                CASE_ELEMENT_WISE(Sub)
+                CASE_ELEMENT_WISE(Mul)
+                CASE_ELEMENT_WISE(Div)
+#undef CASE_ELEMENT_WISE
+            case OpType::Relu:
+                check(1, 1, 0);
+                g->addOpWithOutputs<ReluObj>(in[0], out[0]);
+                break;
+            default:
+                IT_TODO_HALT_MSG("Unknown operator type " +
+                                 std::to_string(type.underlying()));
+            }
+        }
+
+        template <typename T>
+        void put(string &buf, T value)
+        {
+            buf.append(reinterpret_cast<const char *>(&value), sizeof(T));
+        }
+
+        // Reads a mapped model, checking every access against its end.
+        struct Reader
+        {
+            const char *begin, *pos, *end;
+
+            template <typename T>
+            T get()
+            {
+                IT_ASSERT(size_t(end - pos) >= sizeof(T), "Truncated model");
+                T value;
+                std::memcpy(&value, pos, sizeof(T));
+                pos += sizeof(T);
+                return value;
+            }
+
+            // Reads the length of an array of elements of 'size' bytes.
+            uint32_t getCount(size_t size)
+            {
+                uint32_t n = get<uint32_t>();
+                IT_ASSERT(n <= size_t(end - pos) / size, "Truncated model");
+                return n;
+            }
+        };
+
+        // A private read-write mapping of a whole file.
+        struct MappedFile
+        {
+            void *ptr;
+            size_t length;
+
+            MappedFile(void *ptr, size_t length) : ptr(ptr), length(length) {}
+            MappedFile(const MappedFile &) = delete;
+            MappedFile &operator=(const MappedFile &) = delete;
+            ~MappedFile() { munmap(ptr, length); }
+        };
+    } // namespace
+
+    void saveModel(const Graph &graph, const string &path,
+                   const TensorVec &weights)
+    {
+        const auto &tensors = graph->getTensors();
+        const auto &ops = graph->getOperators();
+        std::unordered_map<TensorObj *, uint32_t> index;
+        for (size_t i = 0; i < tensors.size(); ++i)
+            index[tensors[i].get()] = i;
+        std::unordered_set<TensorObj *> isWeight;
+        for (const auto &weight : weights)
+        {
+            IT_ASSERT(index.count(weight.get()) && weight->getDataBlob() &&
+                      weight->isContiguous());
+            isWeight.insert(weight.get());
+        }
+
+        string meta(magic, sizeof(magic));
+        put<uint32_t>(meta, version);
+        put<uint32_t>(meta, tensors.size());
+        put<uint32_t>(meta, ops.size());
+        // The data section starts after the records, which hold every weight
+        // offset: size the records first, then fill the offsets in.
+        vector<size_t> offsetPos;
+        for (const auto &tensor : tensors)
+        {
+            put<uint32_t>(meta, tensor->getDType().getIndex());
+            put<uint32_t>(meta, tensor->getRank());
+            for (auto d : tensor->getDims())
+                put<int32_t>(meta, d);
+            offsetPos.emplace_back(meta.size());
+            put<uint64_t>(meta, 0);
+        }
+        for (const auto &op : ops)
+        {
+            put<uint32_t>(meta, op->getOpType().underlying());
+            put<uint32_t>(meta, op->getInputs().size());
+            put<uint32_t>(meta, op->getOutputs().size());
+            for (const auto &tensors : {op->getInputs(), op->getOutputs()})
+                for (const auto &tensor : tensors)
+                    put<uint32_t>(meta, index.at(tensor.get()));
+            auto attrs = getAttributes(op);
+            put<uint32_t>(meta, attrs.ints.size());
+            for (auto i : attrs.ints)
+                put<int64_t>(meta, i);
+            put<uint32_t>(meta, attrs.floats.size());
+            for (auto f : attrs.floats)
+                put<float>(meta, f);
+        }
+
+        size_t end = meta.size();
+        vector<std::pair<const TensorObj *, size_t>> sections;
+        for (size_t i = 0; i < tensors.size(); ++i)
+        {
+            if (!isWeight.count(tensors[i].get()))
+                continue;
+            size_t offset =
+                (end + weightAlignment - 1) / weightAlignment * weightAlignment;
+            std::memcpy(&meta[offsetPos[i]], &offset, sizeof(uint64_t));
+            sections.emplace_back(tensors[i].get(), offset);
+            end = offset + tensors[i]->getBytes();
+        }
+
+        std::ofstream file(path, std::ios::binary);
+        IT_ASSERT(file.good(), "Cannot open " + path);
+        file.write(meta.data(), meta.size());
+        size_t written = meta.size();
+        for (const auto &[tensor, offset] : sections)
+        {
+            string padding(offset - written, '\0');
+            file.write(padding.data(), padding.size());
+            file.write(tensor->getRawDataPtr<char *>(), tensor->getBytes());
+            written = offset + tensor->getBytes();
+        }
+        IT_ASSERT(file.good(), "Cannot write " + path);
+    }
+
+    Graph loadModel(const string &path, Runtime runtime)
+    {
+        int fd = open(path.c_str(), O_RDONLY);
+        IT_ASSERT(fd >= 0, "Cannot open " + path);
+        struct stat st;
+        bool sized = fstat(fd, &st) == 0 && st.st_size > 0;
+        void *ptr = sized ? mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE,
+                                 MAP_PRIVATE, fd, 0)
+                          : MAP_FAILED;
+        close(fd);
+        IT_ASSERT(ptr != MAP_FAILED, "Cannot map " + path);
+        auto file = make_ref<MappedFile>(ptr, size_t(st.st_size));
+
+        Reader reader{static_cast<char *>(ptr), static_cast<char *>(ptr),
+                      static_cast<char *>(ptr) + st.st_size};
+        IT_ASSERT(file->length >= sizeof(magic) &&
+                      std::memcmp(ptr, magic, sizeof(magic)) == 0,
+                  path + " is not a model");
+        reader.pos += sizeof(magic);
+        uint32_t fileVersion = reader.get<uint32_t>();
+        IT_ASSERT(fileVersion == version, "Unsupported model version");
+        uint32_t nTensors = reader.get<uint32_t>();
+        uint32_t nOps = reader.get<uint32_t>();
+
+        Graph g = make_ref<GraphObj>(runtime);
+        TensorVec tensors;
+        for (uint32_t i = 0; i < nTensors; ++i)
+        {
+            int dtype = reader.get<uint32_t>();
+            IT_ASSERT(dtype > 0 && dtype < int(std::size(DataType::names)),
+                      "Malformed tensor");
+            Shape dims(reader.getCount(sizeof(int32_t)));
+            for (auto &d : dims)
+                d = reader.get<int32_t>();
+            auto tensor = tensors.emplace_back(g->addTensor(dims, DataType(dtype)));
+            if (auto offset = reader.get<uint64_t>())
+            {
+                IT_ASSERT(offset % weightAlignment == 0 &&
+                              offset <= file->length &&
+                              tensor->getBytes() <= file->length - offset,
+                          "Malformed weight");
+                tensor->setExternalBlob(make_ref<BlobObj>(
+                    runtime, static_cast<char *>(ptr) + offset, file));
+            }
+        }
+        auto getTensors = [&](uint32_t n)
+        {
+            TensorVec ret;
+            for (uint32_t i = 0; i < n; ++i)
+            {
+                uint32_t id = reader.get<uint32_t>();
+                IT_ASSERT(id < tensors.size(), "Malformed operator");
+                ret.emplace_back(tensors[id]);
+            }
+            return ret;
+        };
+        for (uint32_t i = 0; i < nOps; ++i)
+        {
+            OpType type(OpType::underlying_t(reader.get<uint32_t>()));
+            uint32_t nIn = reader.getCount(sizeof(uint32_t));
+            uint32_t nOut = reader.getCount(sizeof(uint32_t));
+            auto in = getTensors(nIn);
+            auto out = getTensors(nOut);
+            Attributes attrs;
+            attrs.ints.resize(reader.getCount(sizeof(int64_t)));
+            for (auto &v : attrs.ints)
+                v = reader.get<int64_t>();
+            attrs.floats.resize(reader.getCount(sizeof(float)));
+            for (auto &v : attrs.floats)
+                v = reader.get<float>();
+            addOperator(g, type, in, out, attrs);
+        }
+        return g;
+    }
+} // namespace infini
@@ -0,0 +1,944 @@
+#include "core/onnx.h"
+#include "core/runtime.h"
+#include "operators/concat.h"
+#include "operators/element_wise.h"
+#include "operators/matmul.h"
+#include "operators/reshape.h"
+#include "operators/transpose.h"
+#include "operators/unary.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace infini
+{
+    namespace
+    {
+        using std::string_view;
+
+        constexpr size_t weightAlignment = 64;
+
+        // A view of bytes in the mapped model.
+        struct Span
+        {
+            const uint8_t *begin = nullptr, *end = nullptr;
+
+            size_t size() const { return end - begin; }
+            string_view str() const
+            {
+                return {reinterpret_cast<const char *>(begin), size()};
+            }
+        };
+
+        // Walks the fields of one protobuf message, checking every access
+        // against its end. Only the wire format is known here: the meaning
+        // of the fields is up to the caller.
+        struct Wire
+        {
+            enum Type
+            {
+                Varint = 0,
+                Fixed64 = 1,
+                Bytes = 2,
+                Fixed32 = 5,
+            };
+
+            const uint8_t *pos, *end;
+
+            explicit Wire(Span span) : pos(span.begin), end(span.end) {}
+
+            bool done() const { return pos == end; }
+
+            uint64_t varint()
+            {
+                uint64_t value = 0;
+                for (int shift = 0;; shift += 7)
+                {
+                    IT_ASSERT(pos != end, "Truncated ONNX model");
+                    IT_ASSERT(shift < 64, "Malformed varint in ONNX model");
+                    uint8_t byte = *pos++;
+                    value |= uint64_t(byte & 0x7f) << shift;
+                    if (!(byte & 0x80))
+                        return value;
+                }
+            }
+
+            template <typename T>
+            T fixed()
+            {
+                IT_ASSERT(size_t(end - pos) >= sizeof(T), "Truncated ONNX model");
+                T value;
+                std::memcpy(&value, pos, sizeof(T));
+                pos += sizeof(T);
+                return value;
+            }
+
+            Span bytes()
+            {
+                uint64_t n = varint();
+                IT_ASSERT(n <= uint64_t(end - pos), "Truncated ONNX model");
+                Span span{pos, pos + n};
+                pos += n;
+                return span;
+            }
+
+            // Reads the key of the next field and returns its number.
+            uint32_t next(int &type)
+            {
+                uint64_t key = varint();
+                type = key & 7;
+                return key >> 3;
+            }
+
+            void skip(int type)
+            {
+                switch (type)
+                {
+                case Varint:
+                    varint();
+                    break;
+                case Fixed64:
+                    fixed<uint64_t>();
+                    break;
+                case Bytes:
+                    bytes();
+                    break;
+                case Fixed32:
+                    fixed<uint32_t>();
+                    break;
+                default:
+                    IT_TODO_HALT_MSG("Unsupported wire type " +
+                                     std::to_string(type) + " in ONNX model");
+                }
+            }
+
+            // Calls 'f' with the bit pattern of every element of a repeated
+            // numeric field, whether it is packed or not.
+            template <typename F>
+            void repeated(int type, F &&f)
+            {
+                auto element = [&](Wire &wire, int elementType) -> uint64_t
+                {
+                    if (elementType == Varint)
+                        return wire.varint();
+                    if (elementType == Fixed32)
+                        return wire.fixed<uint32_t>();
+                    IT_ASSERT(elementType == Fixed64, "Malformed ONNX model");
+                    return wire.fixed<uint64_t>();
+                };
+                if (type != Bytes)
+                {
+                    f(element(*this, type));
+                    return;
+                }
+                // A packed field does not say how its elements are encoded,
+                // the caller does through the element type it expects.
+                Wire packed(bytes());
+                while (!packed.done())
+                    f(element(packed, packedType));
+            }
+
+            // The encoding of the elements of packed fields read next.
+            int packedType = Varint;
+        };
+
+        // An initializer, or the value of a Constant node. Its data stays in
+        // the mapping until it is decoded into a tensor.
+        struct TensorInfo
+        {
+            string_view name;
+            int dtype = 0;
+            Shape dims;
+            Span message;
+
+            size_t size() const
+            {
+                size_t n = 1;
+                for (auto d : dims)
+                    n *= d;
+                return n;
+            }
+        };
+
+        struct Attribute
+        {
+            string_view name;
+            int64_t i = 0;
+            float f = 0;
+            vector<int64_t> ints;
+            vector<float> floats;
+            std::optional<TensorInfo> t;
+        };
+
+        struct Node
+        {
+            string_view opType, domain;
+            vector<string_view> inputs, outputs;
+            vector<Attribute> attributes;
+
+            const Attribute *get(string_view name) const
+            {
+                for (const auto &attr : attributes)
+                    if (attr.name == name)
+                        return &attr;
+                return nullptr;
+            }
+
+            // The 'i'-th input, or an empty name if it is absent.
+            string_view input(size_t i) const
+            {
+                return i < inputs.size() ? inputs[i] : string_view();
+            }
+        };
+
+        struct ValueInfo
+        {
+            string_view name;
+            int dtype = 0;
+            vector<int64_t> dims;
+            // The first symbolic dimension, if any.
+            string_view symbol;
+        };
+
+        struct OnnxGraph
+        {
+            vector<Node> nodes;
+            vector<TensorInfo> initializers;
+            vector<ValueInfo> inputs, outputs;
+        };
+
+        Shape toShape(const vector<int64_t> &dims)
+        {
+            Shape shape;
+            for (auto d : dims)
+            {
+                IT_ASSERT(d >= 0 && d <= std::numeric_limits<int>::max(),
+                          "Unsupported dimension " + std::to_string(d));
+                shape.emplace_back(d);
+            }
+            return shape;
+        }
+
+        TensorInfo parseTensor(Span message)
+        {
+            TensorInfo info;
+            info.message = message;
+            vector<int64_t> dims;
+            Wire wire(message);
+            while (!wire.done())
+            {
+                int type;
+                switch (wire.next(type))
+                {
+                case 1: // dims
+                    wire.repeated(type, [&](uint64_t d)
+                                  { dims.emplace_back(d); });
+                    break;
+                case 2: // data_type
+                    info.dtype = wire.varint();
+                    break;
+                case 8: // name
+                    info.name = wire.bytes().str();
+                    break;
+                case 14: // data_location
+                    IT_ASSERT(wire.varint() == 0,
+                              "External ONNX data is not supported");
+                    break;
+                default:
+                    wire.skip(type);
+                }
+            }
+            info.dims = toShape(dims);
+            return info;
+        }
+
+        Attribute parseAttribute(Span message)
+        {
+            Attribute attr;
+            Wire wire(message);
+            while (!wire.done())
+            {
+                int type;
+                switch (wire.next(type))
+                {
+                case 1: // name
+                    attr.name = wire.bytes().str();
+                    break;
+                case 2: // f
+                    attr.f = wire.fixed<float>();
+                    break;
+                case 3: // i
+                    attr.i = wire.varint();
+                    break;
+                case 5: // t
+                    attr.t = parseTensor(wire.bytes());
+                    break;
+                case 7: // floats
+                    wire.packedType = Wire::Fixed32;
+                    wire.repeated(type, [&](uint64_t bits)
+                                  {
+                                      uint32_t u = bits;
+                                      float f;
+                                      std::memcpy(&f, &u, sizeof(f));
+                                      attr.floats.emplace_back(f); });
+                    wire.packedType = Wire::Varint;
+                    break;
+                case 8: // ints
+                    wire.repeated(type, [&](uint64_t i)
+                                  { attr.ints.emplace_back(i); });
+                    break;
+                default:
+                    wire.skip(type);
+                }
+            }
+            return attr;
+        }
+
+        Node parseNode(Span message)
+        {
+            Node node;
+            Wire wire(message);
+            while (!wire.done())
+            {
+                int type;
+                switch (wire.next(type))
+                {
+                case 1: // input
+                    node.inputs.emplace_back(wire.bytes().str());
+                    break;
+                case 2: // output
+                    node.outputs.emplace_back(wire.bytes().str());
+                    break;
+                case 4: // op_type
+                    node.opType = wire.bytes().str();
+                    break;
+                case 5: // attribute
+                    node.attributes.emplace_back(parseAttribute(wire.bytes()));
+                    break;
+                case 7: // domain
+                    node.domain = wire.bytes().str();
+                    break;
+                default:
+                    wire.skip(type);
+                }
+            }
+            return node;
+        }
+
+        // ValueInfoProto.type.tensor_type.{elem_type, shape.dim[]}
+        ValueInfo parseValueInfo(Span message)
+        {
+            ValueInfo info;
+            auto fields = [](Span span, auto &&f)
+            {
+                Wire wire(span);
+                while (!wire.done())
+                {
+                    int type;
+                    uint32_t number = wire.next(type);
+                    if (!f(wire, number, type))
+                        wire.skip(type);
+                }
+            };
+            auto dim = [&](Span span)
+            {
+                bool known = false;
+                fields(span, [&](Wire &wire, uint32_t number, int type)
+                       {
+                           if (number == 1 && type == Wire::Varint)
+                           {
+                               info.dims.emplace_back(wire.varint());
+                               known = true;
+                               return true;
+                           }
+                           if (number == 2 && type == Wire::Bytes)
+                           {
+                               if (info.symbol.empty())
+                                   info.symbol = wire.bytes().str();
+                               else
+                                   wire.bytes();
+                               return true;
+                           }
+                           return false; });
+                if (!known)
+                {
+                    info.dims.emplace_back(0);
+                    if (info.symbol.empty())
+                        info.symbol = "?";
+                }
+            };
+            auto tensorType = [&](Span span)
+            {
+                fields(span, [&](Wire &wire, uint32_t number, int type)
+                       {
+                           if (number == 1 && type == Wire::Varint)
+                               info.dtype = wire.varint();
+                           else if (number == 2 && type == Wire::Bytes)
+                               fields(wire.bytes(), [&](Wire &w, uint32_t n, int t)
+                                      {
+                                          if (n != 1 || t != Wire::Bytes)
+                                              return false;
+                                          dim(w.bytes());
+                                          return true; });
+                           else
+                               return false;
+                           return true; });
+            };
+            fields(message, [&](Wire &wire, uint32_t number, int type)
+                   {
+                       if (number == 1 && type == Wire::Bytes)
+                           info.name = wire.bytes().str();
+                       else if (number == 2 && type == Wire::Bytes)
+                           fields(wire.bytes(), [&](Wire &w, uint32_t n, int t)
+                                  {
+                                      if (n != 1 || t != Wire::Bytes)
+                                          return false;
+                                      tensorType(w.bytes());
+                                      return true; });
+                       else
+                           return false;
+                       return true; });
+            return info;
+        }
+
+        OnnxGraph parseModel(Span file)
+        {
+            OnnxGraph graph;
+            bool found = false;
+            Wire model(file);
+            while (!model.done())
+            {
+                int type;
+                if (model.next(type) != 7 || type != Wire::Bytes) // graph
+                {
+                    model.skip(type);
+                    continue;
+                }
+                found = true;
+                Wire wire(model.bytes());
+                while (!wire.done())
+                {
+                    switch (wire.next(type))
+                    {
+                    case 1: // node
+                        graph.nodes.emplace_back(parseNode(wire.bytes()));
+                        break;
+                    case 5: // initializer
+                        graph.initializers.emplace_back(
+                            parseTensor(wire.bytes()));
+                        break;
+                    case 11: // input
+                        graph.inputs.emplace_back(parseValueInfo(wire.bytes()));
+                        break;
+                    case 12: // output
+                        graph.outputs.emplace_back(
+                            parseValueInfo(wire.bytes()));
+                        break;
+                    default:
+                        wire.skip(type);
+                    }
+                }
+            }
+            IT_ASSERT(found, "The ONNX model has no graph");
+            return graph;
+        }
+
+        // Decodes the data of 'info' into 'dst', which holds info.size()
+        // elements. ONNX stores it either as raw little-endian bytes or in a
+        // typed field whose elements may be wider than the data type.
+        void decodeTensor(const TensorInfo &info, void *dst)
+        {
+            DataType dtype(info.dtype);
+            size_t elementSize = dtype.getSize(), n = info.size();
+            auto out = static_cast<uint8_t *>(dst);
+            size_t written = 0;
+            auto store = [&](uint64_t bits)
+            {
+                IT_ASSERT(written < n, "Too much data for ONNX tensor " +
+                                           string(info.name));
+                // Little-endian: the low bytes hold the narrowed value.
+                std::memcpy(out + written * elementSize, &bits, elementSize);
+                ++written;
+            };
+            Wire wire(info.message);
+            while (!wire.done())
+            {
+                int type;
+                switch (wire.next(type))
+                {
+                case 4: // float_data
+                    wire.packedType = Wire::Fixed32;
+                    wire.repeated(type, store);
+                    break;
+                case 5:  // int32_data
+                case 7:  // int64_data
+                case 11: // uint64_data
+                    wire.packedType = Wire::Varint;
+                    wire.repeated(type, store);
+                    break;
+                case 10: // double_data
+                    wire.packedType = Wire::Fixed64;
+                    wire.repeated(type, store);
+                    break;
+                case 9: // raw_data
+                {
+                    Span raw = wire.bytes();
+                    IT_ASSERT(written == 0 && raw.size() == n * elementSize,
+                              "Malformed ONNX tensor " + string(info.name));
+                    std::memcpy(out, raw.begin, raw.size());
+                    written = n;
+                    break;
+                }
+                default:
+                    wire.skip(type);
+                }
+            }
+            IT_ASSERT(written == n,
+                      "Missing data for ONNX tensor " + string(info.name));
+        }
+
+        bool isSupportedType(int dtype)
+        {
+            return dtype > 0 && dtype < int(std::size(DataType::names)) &&
+                   dtype != DataType::String.getIndex() &&
+                   DataType(dtype).getSize() > 0;
+        }
+
+        // The operators of the default domain that have a counterpart here.
+        bool isSupported(const Node &node)
+        {
+            static const std::unordered_set<string_view> supported = {
+                "Add", "Sub", "Mul", "Div", "Relu", "Clip", "Cast",
+                "Concat", "MatMul", "Gemm", "Transpose", "Reshape",
+                "Flatten", "Squeeze", "Unsqueeze", "Identity", "Constant"};
+            return (node.domain.empty() || node.domain == "ai.onnx") &&
+                   supported.count(node.opType);
+        }
+
+        std::optional<CastType> castTypeOf(DataType from, DataType to)
+        {
+            static const std::tuple<DataType, DataType, CastType> casts[] = {
+                {DataType::Float32, DataType::Float16, CastType::Float2Float16},
+                {DataType::Float32, DataType::Int64, CastType::Float2Int64},
+                {DataType::Float32, DataType::Int32, CastType::Float2Int32},
+                {DataType::Float32, DataType::Int16, CastType::Float2Int16},
+                {DataType::Float32, DataType::Int8, CastType::Float2Int8},
+                {DataType::Float32, DataType::BFloat16,
+                 CastType::Float2BFloat16},
+                {DataType::Int32, DataType::Float32, CastType::Int322Float},
+                {DataType::Int32, DataType::Int8, CastType::Int322Int8},
+                {DataType::Int32, DataType::Int16, CastType::Int322Int16},
+                {DataType::Int32, DataType::Int64, CastType::Int322Int64},
+                {DataType::Int16, DataType::Float32, CastType::Int162Float},
+                {DataType::Int16, DataType::Int32, CastType::Int162Int32},
+                {DataType::Int8, DataType::Float32, CastType::Int82Float},
+                {DataType::Int8, DataType::Int16, CastType::Int82Int16},
+                {DataType::Int8, DataType::Int32, CastType::Int82Int32},
+                {DataType::UInt8, DataType::Float32, CastType::Uint82Float},
+                {DataType::UInt8, DataType::Int32, CastType::Uint82Int32},
+                {DataType::UInt8, DataType::Int64, CastType::Uint82Int64},
+                {DataType::Int64, DataType::Int32, CastType::Int642Int32},
+                {DataType::Int64, DataType::UInt32, CastType::Int642Uint32},
+                {DataType::Int64, DataType::Float32, CastType::Int642Float},
+                {DataType::UInt32, DataType::Int64, CastType::Uint322Int64},
+                {DataType::Float16, DataType::Float32, CastType::Float162Float},
+                {DataType::BFloat16, DataType::Float32,
+                 CastType::BFloat162Float},
+            };
+            for (const auto &[src, dst, cast] : casts)
+                if (src == from && dst == to)
+                    return cast;
+            return std::nullopt;
+        }
+
+        // A read-only mapping of a whole file, read front to back.
+        struct MappedFile
+        {
+            void *ptr;
+            size_t length;
+
+            explicit MappedFile(const string &path)
+            {
+                int fd = open(path.c_str(), O_RDONLY);
+                IT_ASSERT(fd >= 0, "Cannot open " + path);
+                struct stat st;
+                bool sized = fstat(fd, &st) == 0 && st.st_size > 0;
+                length = sized ? st.st_size : 0;
+                ptr = sized ? mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0)
+                            : MAP_FAILED;
+                close(fd);
+                IT_ASSERT(ptr != MAP_FAILED, "Cannot map " + path);
+                madvise(ptr, length, MADV_SEQUENTIAL);
+            }
+            MappedFile(const MappedFile &) = delete;
+            MappedFile &operator=(const MappedFile &) = delete;
+            ~MappedFile() { munmap(ptr, length); }
+
+            Span span() const
+            {
+                auto begin = static_cast<const uint8_t *>(ptr);
+                return {begin, begin + length};
+            }
+
+            // Drops the pages that lie entirely before 'end' from the
+            // process. They are clean and are read again if touched.
+            void release(const uint8_t *end)
+            {
+                size_t page = sysconf(_SC_PAGESIZE);
+                auto begin = static_cast<uint8_t *>(ptr) + released;
+                size_t bytes = (end - begin) / page * page;
+                if (end <= begin || bytes == 0)
+                    return;
+                madvise(begin, bytes, MADV_DONTNEED);
+                released += bytes;
+            }
+
+        private:
+            size_t released = 0;
+        };
+
+        // The memory holding the weights of an imported graph.
+        struct WeightArena
+        {
+            Runtime runtime;
+            void *ptr;
+
+            WeightArena(Runtime runtime, size_t size)
+                : runtime(runtime), ptr(runtime->alloc(size)) {}
+            WeightArena(const WeightArena &) = delete;
+            WeightArena &operator=(const WeightArena &) = delete;
+            ~WeightArena() { runtime->dealloc(ptr); }
+        };
+
+        class Importer
+        {
+            const OnnxGraph &onnx;
+            Graph g;
+            std::unordered_map<string_view, Tensor> values;
+            std::unordered_map<string_view, const TensorInfo *> constants;
+            // The constants bound to tensors, in order of their data.
+            vector<std::pair<const TensorInfo *, Tensor>> weights;
+
+        public:
+            Importer(const OnnxGraph &onnx, Runtime runtime)
+                : onnx(onnx), g(make_ref<GraphObj>(runtime))
+            {
+                for (const auto &init : onnx.initializers)
+                    constants[init.name] = &init;
+            }
+
+            Graph getGraph() const { return g; }
+
+            // Builds the operators and binds every weight to its slot in one
+            // arena. Nothing is decoded yet, so any error in the model is
+            // caught before the weights are read.
+            OnnxModel build(Ref<WeightArena> &arena)
+            {
+                OnnxModel model{g, {}, {}};
+                for (const auto &input : onnx.inputs)
+                {
+                    if (constants.count(input.name))
+                        continue; // listed as an input by older exporters
+                    IT_ASSERT(input.symbol.empty(),
+                              "Input " + string(input.name) +
+                                  " has a symbolic dimension " +
+                                  string(input.symbol));
+                    IT_ASSERT(isSupportedType(input.dtype),
+                              "Unsupported type of input " + string(input.name));
+                    auto tensor = g->addTensor(toShape(input.dims),
+                                               DataType(input.dtype));
+                    values[input.name] = tensor;
+                    model.inputs.emplace_back(tensor);
+                }
+                for (const auto &node : onnx.nodes)
+                    addNode(node);
+                for (const auto &output : onnx.outputs)
+                    model.outputs.emplace_back(get(output.name));
+
+                size_t size = 0;
+                vector<size_t> offsets;
+                for (const auto &[info, tensor] : weights)
+                {
+                    offsets.emplace_back(size);
+                    size += (tensor->getBytes() + weightAlignment - 1) /
+                            weightAlignment * weightAlignment;
+                }
+                if (size == 0)
+                    return model;
+                auto runtime = g->getRuntime();
+                arena = make_ref<WeightArena>(runtime, size);
+                for (size_t i = 0; i < weights.size(); ++i)
+                    weights[i].second->setExternalBlob(make_ref<BlobObj>(
+                        runtime, static_cast<char *>(arena->ptr) + offsets[i],
+                        arena));
+                return model;
+            }
+
+            // Decodes the weights into their slots, in file order, dropping
+            // the pages of the file behind them.
+            void load(MappedFile &file)
+            {
+                std::sort(weights.begin(), weights.end(),
+                          [](const auto &a, const auto &b)
+                          { return a.first->message.begin <
+                                   b.first->message.begin; });
+                for (const auto &[info, tensor] : weights)
+                {
+                    decodeTensor(*info, tensor->getRawDataPtr<void *>());
+                    file.release(info->message.end);
+                }
+            }
+
+        private:
+            // The tensor named 'name', binding a constant to a new weight.
+            Tensor get(string_view name)
+            {
+                if (auto it = values.find(name); it != values.end())
+                    return it->second;
+                auto it = constants.find(name);
+                IT_ASSERT(it != constants.end(),
+                          "Unknown ONNX value " + string(name));
+                const TensorInfo *info = it->second;
+                IT_ASSERT(isSupportedType(info->dtype),
+                          "Unsupported type of " + string(name));
+                auto tensor = g->addTensor(info->dims, DataType(info->dtype));
+                weights.emplace_back(info, tensor);
+                return values[name] = tensor;
+            }
+
+            const TensorInfo &getConstant(const Node &node, size_t i)
+            {
+                auto name = node.input(i);
+                auto it = constants.find(name);
+                IT_ASSERT(it != constants.end(),
+                          string(node.opType) + " needs a constant input " +
+                              string(name));
+                return *it->second;
+            }
+
+            vector<int> getInts(const Node &node, size_t i)
+            {
+                const auto &info = getConstant(node, i);
+                DataType dtype(info.dtype);
+                IT_ASSERT(dtype == DataType::Int64 || dtype == DataType::Int32,
+                          "Malformed " + string(node.opType));
+                vector<int> ret;
+                if (dtype == DataType::Int64)
+                {
+                    vector<int64_t> data(info.size());
+                    decodeTensor(info, data.data());
+                    ret.assign(data.begin(), data.end());
+                }
+                else
+                {
+                    ret.resize(info.size());
+                    decodeTensor(info, ret.data());
+                }
+                return ret;
+            }
+
+            std::optional<float> getFloat(const Node &node, size_t i)
+            {
+                if (node.input(i).empty())
+                    return std::nullopt;
+                const auto &info = getConstant(node, i);
+                IT_ASSERT(DataType(info.dtype) == DataType::Float32 &&
+                              info.size() == 1,
+                          "Malformed " + string(node.opType));
+                float value;
+                decodeTensor(info, &value);
+                return value;
+            }
+
+            vector<int> getAxes(const Node &node)
+            {
+                if (auto attr = node.get("axes"))
+                    return vector<int>(attr->ints.begin(), attr->ints.end());
+                if (node.input(1).empty())
+                    return {};
+                return getInts(node, 1);
+            }
+
+            void addNode(const Node &node)
+            {
+                auto op = node.opType;
+                IT_ASSERT(node.outputs.size() == 1,
+                          string(op) + " must have one output");
+                auto name = node.outputs[0];
+                if (op == "Constant")
+                {
+                    auto value = node.get("value");
+                    IT_ASSERT(value && value->t,
+                              "Only tensor values of Constant are supported");
+                    constants[name] = &*value->t;
+                    return;
+                }
+                IT_ASSERT(!node.inputs.empty(), "Malformed " + string(op));
+                auto x = get(node.inputs[0]);
+                Tensor y;
+                if (op == "Add" || op == "Sub" || op == "Mul" || op == "Div")
+                {
+                    IT_ASSERT(node.inputs.size() == 2, "Malformed " + string(op));
+                    auto b = get(node.inputs[1]);
+                    if (op == "Add")
+                        y = g->addOp<AddObj>(x, b, nullptr)->getOutput();
+                    else if (op == "Sub")
+                        y = g->addOp<SubObj>(x, b, nullptr)->getOutput();
+                    else if (op == "Mul")
+                        y = g->addOp<MulObj>(x, b, nullptr)->getOutput();
+                    else
+                        y = g->addOp<DivObj>(x, b, nullptr)->getOutput();
+                }
+                else if (op == "Relu")
+                    y = g->addOp<ReluObj>(x, nullptr)->getOutput();
+                else if (op == "Clip")
+                {
+                    // Opset 11 turned the bounds into inputs.
+                    auto min = node.get("min"), max = node.get("max");
+                    auto lo = min ? std::optional<float>(min->f) : getFloat(node, 1);
+                    auto hi = max ? std::optional<float>(max->f) : getFloat(node, 2);
+                    y = g->addOp<ClipObj>(x, nullptr, lo, hi)->getOutput();
+                }
+                else if (op == "Cast")
+                {
+                    auto to = node.get("to");
+                    IT_ASSERT(to && isSupportedType(to->i), "Malformed Cast");
+                    DataType from = x->getDType();
+                    if (from == DataType(to->i))
+                        y = g->addOp<ReshapeObj>(x, nullptr, x->getDims())
+                                ->getOutput();
+                    else
+                    {
+                        auto cast = castTypeOf(from, DataType(to->i));
+                        IT_ASSERT(cast, "Unsupported Cast from " +
+                                            from.toString() + " to " +
+                                            DataType(to->i).toString());
+                        y = g->addOp<CastObj>(x, nullptr, *cast)->getOutput();
+                    }
+                }
+                else if (op == "Concat")
+                {
+                    auto axis = node.get("axis");
+                    IT_ASSERT(axis, "Malformed Concat");
+                    TensorVec inputs;
+                    for (auto input : node.inputs)
+                        inputs.emplace_back(get(input));
+                    y = g->addOp<ConcatObj>(inputs, nullptr, axis->i)->getOutput();
+                }
+                else if (op == "MatMul")
+                {
+                    IT_ASSERT(node.inputs.size() == 2, "Malformed MatMul");
+                    y = g->addOp<MatmulObj>(x, get(node.inputs[1]), nullptr)
+                            ->getOutput();
+                }
+                else if (op == "Gemm")
+                    y = addGemm(node, x);
+                else if (op == "Transpose")
+                {
+                    vector<int> perm;
+                    if (auto attr = node.get("perm"))
+                        perm.assign(attr->ints.begin(), attr->ints.end());
+                    else
+                        for (int i = x->getRank() - 1; i >= 0; --i)
+                            perm.emplace_back(i);
+                    y = g->addOp<TransposeObj>(x, nullptr, perm)->getOutput();
+                }
+                else if (op == "Reshape")
+                {
+                    auto shape = getInts(node, 1);
+                    auto allowzero = node.get("allowzero");
+                    IT_ASSERT(!allowzero || !allowzero->i ||
+                                  std::find(shape.begin(), shape.end(), 0) ==
+                                      shape.end(),
+                              "Reshape with allowzero is not supported");
+                    y = g->addOp<ReshapeObj>(x, nullptr, shape)->getOutput();
+                }
+                else if (op == "Flatten")
+                {
+                    auto axis = node.get("axis");
+                    y = g->addOp<FlattenObj>(x, nullptr, axis ? axis->i : 1)
+                            ->getOutput();
+                }
+                else if (op == "Squeeze")
+                    y = g->addOp<SqueezeObj>(x, nullptr, getAxes(node))
+                            ->getOutput();
+                else if (op == "Unsqueeze")
+                    y = g->addOp<UnsqueezeObj>(x, nullptr, getAxes(node))
+                            ->getOutput();
+                else if (op == "Identity")
+                    y = g->addOp<ReshapeObj>(x, nullptr, x->getDims())
+                            ->getOutput();
+                else
+                    IT_TODO_HALT_MSG("Unsupported ONNX operator " + string(op));
+                values[name] = y;
+            }
+
+            // Y = alpha * A' * B' + beta * C, as a MatMul and an Add.
+            Tensor addGemm(const Node &node, const Tensor &a)
+            {
+                IT_ASSERT(node.inputs.size() == 2 || node.inputs.size() == 3,
+                          "Malformed Gemm");
+                auto alpha = node.get("alpha"), beta = node.get("beta");
+                auto transA = node.get("transA"), transB = node.get("transB");
+                bool hasC = !node.input(2).empty();
+                IT_ASSERT((!alpha || alpha->f == 1.0f) &&
+                              (!hasC || !beta || beta->f == 1.0f),
+                          "Gemm with alpha or beta other than 1 is not supported");
+                auto y = g->addOp<MatmulObj>(a, get(node.inputs[1]), nullptr,
+                                             transA && transA->i,
+                                             transB && transB->i)
+                             ->getOutput();
+                if (!hasC)
+                    return y;
+                return g->addOp<AddObj>(y, get(node.inputs[2]), nullptr)
+                    ->getOutput();
+            }
+        };
+    } // namespace
+
+    namespace
+    {
+        vector<string> unsupportedOperators(const OnnxGraph &onnx)
+        {
+            vector<string> ret;
+            for (const auto &node : onnx.nodes)
+            {
+                if (isSupported(node))
+                    continue;
+                string name = string(node.opType);
+                if (!node.domain.empty())
+                    name = string(node.domain) + "." + name;
+                if (std::find(ret.begin(), ret.end(), name) == ret.end())
+                    ret.emplace_back(name);
+            }
+            return ret;
+        }
+    } // namespace
+
+    vector<string> unsupportedOnnxOperators(const string &path)
+    {
+        MappedFile file(path);
+        return unsupportedOperators(parseModel(file.span()));
+    }
+
+    OnnxModel importOnnx(const string &path, Runtime runtime)
+    {
+        MappedFile file(path);
+        auto onnx = parseModel(file.span());
+        auto unsupported = unsupportedOperators(onnx);
+        if (!unsupported.empty())
+        {
+            string msg = path + " has unsupported operators:";
+            for (const auto &name : unsupported)
+                msg += " " + name;
+            IT_TODO_HALT_MSG(msg);
+        }
+
+        Importer importer(onnx, runtime);
+        Ref<WeightArena> arena;
+        auto model = importer.build(arena);
+        importer.load(file);
+        return model;
+    }
+} // namespace infini
@@ -21,6 +21,11 @@ namespace infini
             CASE(Transpose);
             CASE(Concat);
             CASE(MatMul);
+            CASE(Flatten);
+            CASE(Reshape);
+            CASE(Squeeze);
+            CASE(Unsqueeze);
+            CASE(FusedElementWise);
 
         default:
             return "Unknown";
@@ -0,0 +1,25 @@
+#include "core/replay.h"
+#include "core/runtime.h"
+
+namespace infini
+{
+    ReplayObj::ReplayObj(const Graph &graph) : graph(graph)
+    {
+        IT_ASSERT(graph->allocated, "Call dataMalloc before capturing");
+        const auto &kernelRegistry = KernelRegistry::getInstance();
+        auto runtime = graph->getRuntime();
+        for (const auto &op : graph->getOperators())
+        {
+            auto kernelAttrs = KernelAttrs{Device::CPU,
+                                           op->getOpType().underlying()};
+            auto launch = kernelRegistry.getKernel(kernelAttrs)
+                              ->capture(op, runtime.get());
+            if (!launch.fn)
+                continue;
+            // Launches may depend on the outputs of earlier ones, so the
+            // capturing run goes through them in order.
+            launch.fn(launch.args.get());
+            launches.emplace_back(std::move(launch));
+        }
+    }
+} // namespace infini
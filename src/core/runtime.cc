@@ -1,36 +1,425 @@
 #include "core/runtime.h"
 #include "core/blob.h"
-#include "core/kernel.h"
+#include "core/execution_context.h"
 #include "core/graph.h"
 #include "core/kernel.h"
 #include <chrono>
+#include <cstdlib>
 #include <cstring>
+#include <fcntl.h>
+#include <fstream>
 #include <memory>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 namespace infini
 {
-    void NativeCpuRuntimeObj::run(const Graph &graph) const
+    void NativeCpuRuntimeObj::run(const Graph &graph, bool profiling) const
     {
         const auto &kernelRegistry = KernelRegistry::getInstance();
+        double totalTime = 0;
+        std::map<OpType, double> opTime;
+        std::map<OpType, int> opCnt;
 
         for (auto &op : graph->getOperators())
         {
             auto kernelAttrs = KernelAttrs{device, op->getOpType().underlying()};
             Kernel *kernel = kernelRegistry.getKernel(kernelAttrs);
+            if (!profiling)
+            {
+                kernel->compute(op, this);
+                continue;
+            }
+            auto begin = std::chrono::steady_clock::now();
             kernel->compute(op, this);
+            double t = std::chrono::duration<double, std::milli>(
+                           std::chrono::steady_clock::now() - begin)
+                           .count();
+            totalTime += t;
+            opTime[op->getOpType()] += t;
+            opCnt[op->getOpType()]++;
+        }
+        if (profiling)
+            printProfilingData(totalTime, opTime, opCnt);
+    }
+
+    void RuntimeObj::run(const Graph &graph, const ExecutionContext &context,
+                         bool profiling) const
+    {
+        IT_ASSERT(context->getSource() == graph,
+                  "The context was created for another graph");
+        run(context->getGraph(), profiling);
+    }
+
+    void RuntimeObj::printProfilingData(double totalTime,
+                                        const std::map<OpType, double> &opTime,
+                                        const std::map<OpType, int> &opCnt) const
+    {
+        printf("%11s %3s %7s %7s %7s\n", "Op", "Cnt", "T_tot", "Percent",
+               "T_mean");
+        for (const auto &[type, t] : opTime)
+        {
+            printf("%11s %3d %7.3f %7.1f %7.3f\n", type.toString(),
+                   opCnt.at(type), t, t / totalTime * 100, t / opCnt.at(type));
         }
+        printf("Total time: %.3f ms\n", totalTime);
     }
 
     string NativeCpuRuntimeObj::toString() const { return "CPU Runtime"; }
 
     void NativeCpuRuntimeObj::dealloc(void *ptr)
     {
+        {
+            std::lock_guard<std::mutex> guard(mappingsLock);
+            auto it = mappings.find(ptr);
+            if (it != mappings.end())
+            {
+                munmap(ptr, it->second);
+                mappings.erase(it);
+                return;
+            }
+        }
         return free(ptr);
     }
 
     void *NativeCpuRuntimeObj::alloc(size_t size)
     {
-        return calloc((size + sizeof(uint64_t) - 1) / sizeof(uint64_t),
-                      sizeof(uint64_t));
+        if (size < hugePageSize)
+        {
+            void *ptr = nullptr;
+            IT_ASSERT(posix_memalign(&ptr, alignment, size) == 0,
+                      "Failed to allocate " + std::to_string(size) + " bytes");
+            if (arenaInit == ArenaInit::Zero)
+                memset(ptr, 0, size);
+            return ptr;
+        }
+
+        size_t length;
+        auto ptr = mapArena(size, length);
+#ifdef MADV_HUGEPAGE
+        madvise(ptr, length, MADV_HUGEPAGE);
+#endif
+        touchArena(ptr, length);
+        return ptr;
+    }
+
+    char *NativeCpuRuntimeObj::mapArena(size_t size, size_t &length)
+    {
+        // Over-map by one huge page, then trim both ends so that the arena
+        // starts on a huge page boundary and can be fully covered by them.
+        length = (size + hugePageSize - 1) / hugePageSize * hugePageSize;
+        auto base = static_cast<char *>(mmap(nullptr, length + hugePageSize,
+                                             PROT_READ | PROT_WRITE,
+                                             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+        IT_ASSERT(base != MAP_FAILED,
+                  "Failed to map " + std::to_string(length) + " bytes");
+        auto ptr = reinterpret_cast<char *>(
+            (reinterpret_cast<uintptr_t>(base) + hugePageSize - 1) /
+            hugePageSize * hugePageSize);
+        if (ptr != base)
+            munmap(base, ptr - base);
+        munmap(ptr + length, base + hugePageSize - ptr);
+
+        recordMapping(ptr, length);
+        return ptr;
+    }
+
+    void NativeCpuRuntimeObj::recordMapping(void *ptr, size_t length)
+    {
+        std::lock_guard<std::mutex> guard(mappingsLock);
+        mappings[ptr] = length;
     }
 
+    void NativeCpuRuntimeObj::touchArena(char *ptr, size_t length) const
+    {
+        // Anonymous mappings are zero-filled like the calloc'ed small arenas,
+        // touching them only decides where and when the pages are faulted in.
+        if (arenaInit == ArenaInit::FirstTouch)
+        {
+            const long pageSize = sysconf(_SC_PAGESIZE);
+            const long nPages = length / pageSize;
+#pragma omp parallel for schedule(static)
+            for (long i = 0; i < nPages; ++i)
+                ptr[i * pageSize] = 0;
+        }
+    }
+
+    // Parses a sysfs list such as "0-3,8,10-11".
+    static vector<int> parseList(const string &path)
+    {
+        vector<int> ret;
+        std::ifstream file(path);
+        string range;
+        while (std::getline(file, range, ','))
+        {
+            if (range.empty() || range == "\n")
+                continue;
+            auto dash = range.find('-');
+            int first = std::stoi(range.substr(0, dash));
+            int last =
+                dash == string::npos ? first : std::stoi(range.substr(dash + 1));
+            for (int i = first; i <= last; ++i)
+                ret.emplace_back(i);
+        }
+        return ret;
+    }
+
+    NumaCpuRuntimeObj::NumaCpuRuntimeObj(int node) : node(node)
+    {
+        cpus = parseList("/sys/devices/system/node/node" + std::to_string(node) +
+                         "/cpulist");
+        if (cpus.empty())
+        {
+            // No NUMA information: the only node owns every cpu.
+            IT_ASSERT(node == 0, "NUMA node " + std::to_string(node) +
+                                     " does not exist");
+            for (long i = 0, n = sysconf(_SC_NPROCESSORS_ONLN); i < n; ++i)
+                cpus.emplace_back(i);
+        }
+    }
+
+    vector<int> NumaCpuRuntimeObj::getNodes()
+    {
+        auto nodes = parseList("/sys/devices/system/node/online");
+        return nodes.empty() ? vector<int>{0} : nodes;
+    }
+
+    Ref<NumaCpuRuntimeObj> &NumaCpuRuntimeObj::getInstance(int node)
+    {
+        static std::map<int, Ref<NumaCpuRuntimeObj>> instances = []()
+        {
+            std::map<int, Ref<NumaCpuRuntimeObj>> ret;
+            for (auto n : getNodes())
+                ret[n] = make_ref<NumaCpuRuntimeObj>(n);
+            return ret;
+        }();
+        auto it = instances.find(node);
+        IT_ASSERT(it != instances.end(),
+                  "NUMA node " + std::to_string(node) + " is not online");
+        return it->second;
+    }
+
+    string NumaCpuRuntimeObj::toString() const
+    {
+        return "CPU Runtime (NUMA node " + std::to_string(node) + ")";
+    }
+
+    void NumaCpuRuntimeObj::run(const Graph &graph, bool profiling) const
+    {
+        // The calling thread and the OpenMP workers are shared with the rest
+        // of the process: they only run on the node for the duration of the
+        // run, then get their own masks and team size back, even if a kernel
+        // throws.
+        struct Restore
+        {
+            const NumaCpuRuntimeObj *runtime;
+            vector<cpu_set_t> masks;
+#ifdef _OPENMP
+            int nThreads = omp_get_max_threads();
+#endif
+            ~Restore()
+            {
+                runtime->unbindThreads(masks);
+#ifdef _OPENMP
+                omp_set_num_threads(nThreads);
+#endif
+            }
+        } restore{this, {}};
+        bindThreads(restore.masks);
+        NativeCpuRuntimeObj::run(graph, profiling);
+    }
+
+    void *NumaCpuRuntimeObj::alloc(size_t size)
+    {
+        // Arenas of every size are mapped, mbind works on whole pages.
+        size_t length;
+        auto ptr = mapArena(size, length);
+#ifdef MADV_HUGEPAGE
+        madvise(ptr, length, MADV_HUGEPAGE);
+#endif
+        // Bind before touching anything: pages are placed when they are
+        // faulted in. MPOL_BIND is 2, spelled out to avoid needing libnuma.
+        constexpr int mpolBind = 2;
+        constexpr int bitsPerLong = 8 * sizeof(unsigned long);
+        vector<unsigned long> mask(node / bitsPerLong + 1, 0);
+        mask[node / bitsPerLong] |= 1UL << (node % bitsPerLong);
+        IT_ASSERT(syscall(SYS_mbind, ptr, length, mpolBind, mask.data(),
+                          mask.size() * bitsPerLong + 1, 0) == 0,
+                  "Failed to bind the arena to NUMA node " +
+                      std::to_string(node));
+        touchArena(ptr, length);
+        return ptr;
+    }
+
+    void NumaCpuRuntimeObj::bindThreads(vector<cpu_set_t> &masks) const
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (auto cpu : cpus)
+            CPU_SET(cpu, &set);
+        masks.resize(1);
+        sched_getaffinity(0, sizeof(masks[0]), &masks[0]);
+        sched_setaffinity(0, sizeof(set), &set);
+#ifdef _OPENMP
+        // The team size is a per-thread setting, other threads running graphs
+        // on other nodes keep their own teams.
+        omp_set_num_threads(cpus.size());
+        masks.resize(cpus.size());
+#pragma omp parallel
+        {
+            // Each worker keeps one core. The master is the calling thread
+            // and keeps the node-wide mask.
+            int thread = omp_get_thread_num();
+            if (thread != 0)
+            {
+                sched_getaffinity(0, sizeof(masks[thread]), &masks[thread]);
+                cpu_set_t own;
+                CPU_ZERO(&own);
+                CPU_SET(cpus[thread], &own);
+                sched_setaffinity(0, sizeof(own), &own);
+            }
+        }
+#endif
+    }
+
+    void NumaCpuRuntimeObj::unbindThreads(const vector<cpu_set_t> &masks) const
+    {
+#ifdef _OPENMP
+        // A team of the same size is made of the same pooled workers, in the
+        // same order.
+        omp_set_num_threads(masks.size());
+#pragma omp parallel
+        {
+            int thread = omp_get_thread_num();
+            if (thread != 0 && size_t(thread) < masks.size())
+                sched_setaffinity(0, sizeof(masks[thread]), &masks[thread]);
+        }
+#endif
+        sched_setaffinity(0, sizeof(masks[0]), &masks[0]);
+    }
+
+    OutOfCoreCpuRuntimeObj::OutOfCoreCpuRuntimeObj(string directory,
+                                                   size_t tileBytes)
+        : directory(directory.empty() ? defaultDirectory()
+                                      : std::move(directory)),
+          tileBytes(tileBytes)
+    {
+        IT_ASSERT(tileBytes > 0);
+        prefetcher = std::thread(&OutOfCoreCpuRuntimeObj::prefetchLoop, this);
+    }
+
+    OutOfCoreCpuRuntimeObj::~OutOfCoreCpuRuntimeObj()
+    {
+        {
+            std::lock_guard<std::mutex> guard(queueLock);
+            stopping = true;
+        }
+        queueCond.notify_all();
+        prefetcher.join();
+    }
+
+    string OutOfCoreCpuRuntimeObj::defaultDirectory()
+    {
+        if (auto dir = std::getenv("TMPDIR"); dir && *dir)
+            return dir;
+        return "/var/tmp";
+    }
+
+    void *OutOfCoreCpuRuntimeObj::alloc(size_t size)
+    {
+        // The file is unlinked at once and lives as long as its mapping. It
+        // is sparse, so the arena reads as zeros like the anonymous ones.
+        string path = directory + "/infinitensor-arena-XXXXXX";
+        int fd = mkstemp(path.data());
+        IT_ASSERT(fd >= 0, "Failed to create a file in " + directory);
+        unlink(path.c_str());
+        const size_t pageSize = sysconf(_SC_PAGESIZE);
+        size_t length = std::max<size_t>(
+            (size + pageSize - 1) / pageSize * pageSize, pageSize);
+        bool sized = ftruncate(fd, length) == 0;
+        void *ptr = sized ? mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                                 MAP_SHARED, fd, 0)
+                          : MAP_FAILED;
+        close(fd);
+        IT_ASSERT(ptr != MAP_FAILED, "Failed to map " + std::to_string(length) +
+                                         " bytes from " + directory);
+
+        recordMapping(ptr, length);
+        std::lock_guard<std::mutex> guard(queueLock);
+        arenas[static_cast<const char *>(ptr)] = length;
+        return ptr;
+    }
+
+    void OutOfCoreCpuRuntimeObj::dealloc(void *ptr)
+    {
+        // Pending ranges may lie in this arena, and the range being read
+        // must be done before it is unmapped. The lock is held until then so
+        // no new range in it can be queued.
+        std::unique_lock<std::mutex> lock(queueLock);
+        arenas.erase(static_cast<const char *>(ptr));
+        queue.clear();
+        queueCond.wait(lock, [&]
+                       { return !busy; });
+        NativeCpuRuntimeObj::dealloc(ptr);
+    }
+
+    void OutOfCoreCpuRuntimeObj::prefetch(const void *ptr, size_t bytes) const
+    {
+        if (bytes == 0)
+            return;
+        {
+            std::lock_guard<std::mutex> guard(queueLock);
+            auto begin = static_cast<const char *>(ptr);
+            auto it = arenas.upper_bound(begin);
+            if (it == arenas.begin() ||
+                begin + bytes > std::prev(it)->first + std::prev(it)->second)
+                return;
+            if (queue.size() == maxQueuedRanges)
+                queue.pop_front();
+            queue.emplace_back(static_cast<const char *>(ptr), bytes);
+        }
+        queueCond.notify_all();
+    }
+
+    void OutOfCoreCpuRuntimeObj::prefetchLoop()
+    {
+        const uintptr_t pageSize = sysconf(_SC_PAGESIZE);
+        while (true)
+        {
+            std::pair<const char *, size_t> range;
+            {
+                std::unique_lock<std::mutex> lock(queueLock);
+                queueCond.wait(lock, [&]
+                               { return stopping || !queue.empty(); });
+                if (stopping)
+                    return;
+                range = queue.front();
+                queue.pop_front();
+                busy = true;
+            }
+            // Start the read-ahead of the whole range, then fault it in page
+            // by page so the kernel does not wait on the file.
+            auto begin = reinterpret_cast<uintptr_t>(range.first) / pageSize *
+                         pageSize;
+            auto end = reinterpret_cast<uintptr_t>(range.first) + range.second;
+            madvise(reinterpret_cast<void *>(begin), end - begin,
+                    MADV_WILLNEED);
+            for (auto page = begin; page < end; page += pageSize)
+                (void)*reinterpret_cast<volatile const char *>(page);
+            {
+                std::lock_guard<std::mutex> guard(queueLock);
+                busy = false;
+            }
+            queueCond.notify_all();
+        }
+    }
+
+    string OutOfCoreCpuRuntimeObj::toString() const
+    {
+        return "CPU Runtime (out of core in " + directory + ")";
+    }
 } // namespace infini
@@ -2,6 +2,7 @@
 #include "core/blob.h"
 #include "core/operator.h"
 #include "core/runtime.h"
+#include "utils/operator_utils.h"
 #include <cstring>
 #include <numeric>
 
@@ -9,7 +10,9 @@ namespace infini {
 
     TensorObj::TensorObj(Shape shape_, DataType dtype, Runtime runtime)
         : dim(shape_.size()), dtype(dtype), runtime(runtime), shape(std::move(shape_)),
-          _size(std::accumulate(shape.begin(), shape.end(), 1, std::multiplies{})) {}
+          _size(std::accumulate(shape.begin(), shape.end(), 1, std::multiplies{})),
+          stride(get_contiguous_stride(shape)), offset(0), view(false),
+          external(false) {}
 
     string TensorObj::toString() const
     {
@@ -39,10 +42,29 @@ void TensorObj::setShape(Shape shape_) {
     size_t size = std::accumulate(shape.begin(), shape.end(), 1,
                                   [](auto acc, auto x) { return acc * x; });
     _size = size;
+    stride = get_contiguous_stride(shape);
+    offset = 0;
+    view = false;
+}
+
+bool TensorObj::isContiguous() const {
+    auto dense = get_contiguous_stride(shape);
+    for (size_t i = 0; i < shape.size(); ++i)
+        if (shape[i] != 1 && stride[i] != dense[i])
+            return false;
+    return true;
+}
+
+void TensorObj::setView(Shape stride_, size_t offset_) {
+    IT_ASSERT(stride_.size() == shape.size());
+    stride = std::move(stride_);
+    offset = offset_;
+    view = true;
 }
 
 void TensorObj::printData() const {
     IT_ASSERT(data != nullptr);
+    IT_ASSERT(isContiguous());
     if (!runtime->isCpu())
         IT_TODO_HALT();
 
@@ -73,6 +95,7 @@ void TensorObj::printData() const {
 bool TensorObj::equalData(const Tensor &rhs, double relativeError) const {
     IT_ASSERT(data != nullptr);
     IT_ASSERT(rhs->data != nullptr);
+    IT_ASSERT(isContiguous() && rhs->isContiguous());
     IT_ASSERT(getDType() == rhs->getDType());
     IT_ASSERT(runtime->isCpu());
     IT_ASSERT(rhs->getRuntime()->isCpu());
@@ -108,9 +131,15 @@ bool TensorObj::equalData(const Tensor &rhs, double relativeError) const {
 void TensorObj::setData(
     const std::function<void(void *, size_t, DataType)> &generator) const {
     IT_ASSERT(data != nullptr);
+    IT_ASSERT(isContiguous());
     generator(getRawDataPtr<void *>(), size(), dtype);
 }
 
 void TensorObj::setDataBlob(const Blob &blob) { this->data = blob; }
 
+void TensorObj::setExternalBlob(const Blob &blob) {
+    this->data = blob;
+    this->external = true;
+}
+
 }; // namespace infini
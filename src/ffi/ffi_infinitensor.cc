@@ -0,0 +1,405 @@
+#include "core/codegen.h"
+#include "core/dlpack.h"
+#include "core/execution_context.h"
+#include "core/graph.h"
+#include "core/jit.h"
+#include "core/model_file.h"
+#include "core/onnx.h"
+#include "core/runtime.h"
+#include "operators/concat.h"
+#include "operators/element_wise.h"
+#include "operators/matmul.h"
+#include "operators/reshape.h"
+#include "operators/transpose.h"
+#include "operators/unary.h"
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+namespace py = pybind11;
+
+namespace infini
+{
+    namespace
+    {
+        // The buffer protocol format of the elements of 'dtype'. Types NumPy
+        // does not know are exposed as unsigned integers of the same size.
+        string formatOf(DataType dtype)
+        {
+            switch (dtype.getIndex())
+            {
+            case 1: // Float32
+                return py::format_descriptor<float>::format();
+            case 2: // UInt8
+                return py::format_descriptor<uint8_t>::format();
+            case 3: // Int8
+                return py::format_descriptor<int8_t>::format();
+            case 4:  // UInt16
+            case 16: // BFloat16
+                return py::format_descriptor<uint16_t>::format();
+            case 5: // Int16
+                return py::format_descriptor<int16_t>::format();
+            case 6: // Int32
+                return py::format_descriptor<int32_t>::format();
+            case 7: // Int64
+                return py::format_descriptor<int64_t>::format();
+            case 9: // Bool
+                return py::format_descriptor<bool>::format();
+            case 10: // Float16
+                return "e";
+            case 11: // Double
+                return py::format_descriptor<double>::format();
+            case 12: // UInt32
+                return py::format_descriptor<uint32_t>::format();
+            case 13: // UInt64
+                return py::format_descriptor<uint64_t>::format();
+            default:
+                IT_TODO_HALT_MSG("No buffer format for " + dtype.toString());
+            }
+            return "";
+        }
+
+        // Whether elements of buffer format 'format' and 'itemsize' bytes
+        // are elements of 'dtype'. Formats are compared by kind and size:
+        // NumPy spells int64 'l' where pybind11 spells it 'q'.
+        bool formatMatches(string format, size_t itemsize, DataType dtype)
+        {
+            if (!format.empty() && string("@=<>!").find(format[0]) != string::npos)
+                format = format.substr(1);
+            auto expected = formatOf(dtype);
+            auto kind = [](char c)
+            {
+                if (string("bhilqn").find(c) != string::npos)
+                    return 'i';
+                if (string("BHILQN").find(c) != string::npos)
+                    return 'u';
+                if (string("efd").find(c) != string::npos)
+                    return 'f';
+                return c;
+            };
+            return format.size() == 1 && itemsize == dtype.getSize() &&
+                   kind(format[0]) == kind(expected[0]);
+        }
+
+        DataType dtypeOf(const string &name)
+        {
+            for (int i = 1; i < int(std::size(DataType::names)); ++i)
+            {
+                string candidate(DataType::names[i]);
+                std::transform(candidate.begin(), candidate.end(),
+                               candidate.begin(), ::tolower);
+                if (candidate == name && DataType(i).getSize() > 0 &&
+                    !(DataType(i) == DataType::String))
+                    return DataType(i);
+            }
+            if (name == "float32" || name == "float")
+                return DataType::Float32;
+            if (name == "float64")
+                return DataType::Double;
+            IT_TODO_HALT_MSG("Unknown data type " + name);
+            return DataType::Undefine;
+        }
+
+        string nameOf(DataType dtype)
+        {
+            string name = dtype.toString();
+            std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+            return name;
+        }
+
+        py::buffer_info bufferOf(TensorObj &tensor)
+        {
+            IT_ASSERT(tensor.getDataBlob() != nullptr,
+                      "Tensor " + std::to_string(tensor.getGuid()) +
+                          " has no memory, call data_malloc first");
+            auto dims = tensor.getDims();
+            auto stride = tensor.getStride();
+            size_t itemsize = tensor.getDType().getSize();
+            vector<py::ssize_t> shape(dims.begin(), dims.end()), strides;
+            for (auto s : stride)
+                strides.emplace_back(s * itemsize);
+            return py::buffer_info(tensor.getRawDataPtr<void *>(), itemsize,
+                                   formatOf(tensor.getDType()), dims.size(),
+                                   shape, strides);
+        }
+
+        // Exports the memory of 'buffer' for 'tensor', checking that it can
+        // hold it. The buffer stays exported, so it can neither be freed nor
+        // resized, until the returned Ref and the blobs sharing it are gone.
+        // Only tensors an operator writes need a writable buffer: kernels
+        // never write over a graph input, so inputs may be read-only arrays.
+        Ref<py::buffer_info> request(const Tensor &tensor,
+                                     const py::buffer &buffer)
+        {
+            bool writable = tensor->getSource() != nullptr;
+            auto info = Ref<py::buffer_info>(
+                new py::buffer_info(buffer.request(writable)),
+                [](py::buffer_info *info)
+                {
+                    // The last reference may be dropped without the GIL,
+                    // e.g. when a graph is destroyed by runtime.run.
+                    py::gil_scoped_acquire gil;
+                    delete info;
+                });
+            auto dims = tensor->getDims();
+            IT_ASSERT(info->ndim == py::ssize_t(dims.size()) &&
+                          std::equal(dims.begin(), dims.end(),
+                                     info->shape.begin()),
+                      "Shape mismatch binding tensor " +
+                          std::to_string(tensor->getGuid()));
+            IT_ASSERT(formatMatches(info->format, info->itemsize,
+                                    tensor->getDType()),
+                      "Cannot bind a buffer of format " + info->format +
+                          " to a " + tensor->getDType().toString() + " tensor");
+            py::ssize_t expected = info->itemsize;
+            for (int i = info->ndim - 1; i >= 0; --i)
+            {
+                IT_ASSERT(info->shape[i] == 1 || info->strides[i] == expected,
+                          "Only C-contiguous buffers can be bound");
+                expected *= info->shape[i];
+            }
+            return info;
+        }
+
+        // Takes the DLManagedTensor out of 'obj', a DLPack capsule or an
+        // object with __dlpack__, and marks the capsule as consumed.
+        DLManagedTensor *consumeDLPack(py::object obj)
+        {
+            if (py::hasattr(obj, "__dlpack__"))
+                obj = obj.attr("__dlpack__")();
+            auto managed = static_cast<DLManagedTensor *>(
+                PyCapsule_GetPointer(obj.ptr(), "dltensor"));
+            if (!managed)
+                throw py::error_already_set();
+            PyCapsule_SetName(obj.ptr(), "used_dltensor");
+            return managed;
+        }
+
+        py::capsule exportDLPack(const Tensor &tensor)
+        {
+            return py::capsule(toDLPack(tensor), "dltensor",
+                               [](PyObject *capsule)
+                               {
+                                   // Release it unless it was consumed.
+                                   if (!PyCapsule_IsValid(capsule, "dltensor"))
+                                       return;
+                                   auto managed =
+                                       static_cast<DLManagedTensor *>(
+                                           PyCapsule_GetPointer(capsule,
+                                                                "dltensor"));
+                                   managed->deleter(managed);
+                               });
+        }
+
+        template <typename T>
+        Tensor binary(const Graph &g, Tensor a, Tensor b)
+        {
+            return g->addOp<T>(a, b, nullptr)->getOutput();
+        }
+    } // namespace
+
+    void export_functions(py::module &m)
+    {
+        m.def("cpu_runtime", []()
+              { return Runtime(NativeCpuRuntimeObj::getInstance()); })
+            .def(
+                "out_of_core_runtime",
+                [](const string &directory, size_t tileBytes)
+                {
+                    return Runtime(make_ref<OutOfCoreCpuRuntimeObj>(directory,
+                                                                    tileBytes));
+                },
+                py::arg("directory") = "",
+                py::arg("tile_bytes") = OutOfCoreCpuRuntimeObj::defaultTileBytes)
+            .def("load_model", &loadModel, py::arg("path"), py::arg("runtime"))
+            .def("save_model", &saveModel, py::arg("graph"), py::arg("path"),
+                 py::arg("weights"))
+            .def(
+                "import_onnx",
+                [](const string &path, Runtime runtime)
+                {
+                    auto model = importOnnx(path, runtime);
+                    return py::make_tuple(model.graph, model.inputs,
+                                          model.outputs);
+                },
+                py::arg("path"), py::arg("runtime"))
+            .def("unsupported_onnx_operators", &unsupportedOnnxOperators,
+                 py::arg("path"))
+            .def("generate_cpp", &generateCpp, py::arg("graph"),
+                 py::arg("inputs"), py::arg("outputs"))
+            .def("compile_cpp", &compileCpp, py::arg("source"),
+                 py::arg("library"), py::arg("compiler") = "c++",
+                 py::arg("flags") = "-O3")
+            .def(
+                "fuse_element_wise",
+                [](const Graph &graph, const string &cacheDir,
+                   const string &compiler, const string &flags)
+                {
+                    return fuseElementWise(graph,
+                                           JitOptions{cacheDir, compiler, flags});
+                },
+                py::arg("graph"), py::arg("cache_dir") = defaultJitCacheDir(),
+                py::arg("compiler") = "c++",
+                py::arg("flags") = "-O3 -march=native");
+    }
+
+    void export_classes(py::module &m)
+    {
+        py::class_<RuntimeObj, Runtime>(m, "Runtime")
+            .def("run",
+                 py::overload_cast<const Graph &, bool>(&RuntimeObj::run,
+                                                        py::const_),
+                 py::arg("graph"), py::arg("profiling") = false,
+                 py::call_guard<py::gil_scoped_release>())
+            .def("run",
+                 py::overload_cast<const Graph &, const ExecutionContext &,
+                                   bool>(&RuntimeObj::run, py::const_),
+                 py::arg("graph"), py::arg("context"),
+                 py::arg("profiling") = false,
+                 py::call_guard<py::gil_scoped_release>())
+            .def("__str__", &RuntimeObj::toString);
+
+        py::class_<TensorObj, Tensor>(m, "Tensor", py::buffer_protocol())
+            .def_buffer(&bufferOf)
+            .def_property_readonly("guid", &TensorObj::getGuid)
+            .def_property_readonly("shape", &TensorObj::getDims)
+            .def_property_readonly("dtype", [](const TensorObj &t)
+                                   { return nameOf(t.getDType()); })
+            .def_property_readonly("nbytes", &TensorObj::getBytes)
+            .def_property_readonly("external", &TensorObj::isExternal)
+            .def_property_readonly("source", &TensorObj::getSource)
+            .def_property_readonly("targets", &TensorObj::getTargets)
+            .def(
+                "bind",
+                [](const Tensor &tensor, const py::buffer &buffer)
+                {
+                    auto info = request(tensor, buffer);
+                    tensor->setExternalBlob(make_ref<BlobObj>(
+                        tensor->getRuntime(), info->ptr, info));
+                },
+                py::arg("buffer"),
+                "Bind the memory of a C-contiguous buffer, such as a NumPy "
+                "array, without copying. Use Graph.bind to bind it again "
+                "after data_malloc.")
+            .def(
+                "__dlpack__",
+                [](const Tensor &tensor, py::object stream)
+                { return exportDLPack(tensor); },
+                py::arg("stream") = py::none())
+            .def("__dlpack_device__", [](const TensorObj &)
+                 { return py::make_tuple(int(kDLCPU), 0); })
+            .def(
+                "bind_dlpack",
+                [](const Tensor &tensor, py::object obj)
+                { bindDLPack(tensor, consumeDLPack(obj)); },
+                py::arg("obj"),
+                "Bind the memory of a DLPack capsule, or of an object with "
+                "__dlpack__, without copying.")
+            .def("__str__", &TensorObj::toString);
+
+        py::class_<OperatorObj, Operator>(m, "Operator")
+            .def_property_readonly("guid", &OperatorObj::getGuid)
+            .def_property_readonly("type", [](const OperatorObj &op)
+                                   { return op.getOpType().toString(); })
+            .def_property_readonly("inputs", [](const OperatorObj &op)
+                                   { return op.getInputs(); })
+            .def_property_readonly("outputs", [](const OperatorObj &op)
+                                   { return op.getOutputs(); })
+            .def("__str__", &OperatorObj::toString);
+
+        py::enum_<ScheduleMode>(m, "ScheduleMode")
+            .value("Topological", ScheduleMode::Topological)
+            .value("MinPeak", ScheduleMode::MinPeak)
+            .value("Locality", ScheduleMode::Locality);
+
+        py::class_<GraphObj, Graph>(m, "Graph")
+            .def(py::init<Runtime>(), py::arg("runtime"))
+            .def_property_readonly("runtime", &GraphObj::getRuntime)
+            .def_property_readonly("tensors", &GraphObj::getTensors)
+            .def_property_readonly("operators", &GraphObj::getOperators)
+            .def_property_readonly("inputs", &GraphObj::getInputs)
+            .def_property_readonly("outputs", &GraphObj::getOutputs)
+            .def(
+                "tensor",
+                [](GraphObj &g, const Shape &shape, const string &dtype)
+                { return g.addTensor(shape, dtypeOf(dtype)); },
+                py::arg("shape"), py::arg("dtype") = "float32")
+            .def("set_external", &GraphObj::setExternal, py::arg("tensor"))
+            .def(
+                "bind",
+                [](GraphObj &g, const Tensor &tensor, const py::buffer &buffer)
+                {
+                    auto info = request(tensor, buffer);
+                    g.bind(tensor, info->ptr, info);
+                },
+                py::arg("tensor"), py::arg("buffer"),
+                "Bind a C-contiguous buffer to a graph input or output for the "
+                "next runs, without copying, see GraphObj::bind.")
+            .def(
+                "from_dlpack",
+                [](const Graph &g, py::object obj)
+                { return fromDLPack(g, consumeDLPack(obj)); },
+                py::arg("obj"))
+            .def("set_schedule_mode", &GraphObj::setScheduleMode)
+            .def("optimize", &GraphObj::optimize)
+            .def("data_malloc", &GraphObj::dataMalloc, py::arg("budget") = 0)
+            .def("add", &binary<AddObj>)
+            .def("sub", &binary<SubObj>)
+            .def("mul", &binary<MulObj>)
+            .def("div", &binary<DivObj>)
+            .def("matmul",
+                 [](const Graph &g, Tensor a, Tensor b, bool transA, bool transB)
+                 {
+                     return g->addOp<MatmulObj>(a, b, nullptr, transA, transB)
+                         ->getOutput();
+                 },
+                 py::arg("a"), py::arg("b"), py::arg("trans_a") = false,
+                 py::arg("trans_b") = false)
+            .def("relu", [](const Graph &g, Tensor x)
+                 { return g->addOp<ReluObj>(x, nullptr)->getOutput(); })
+            .def(
+                "clip",
+                [](const Graph &g, Tensor x, std::optional<float> min,
+                   std::optional<float> max)
+                { return g->addOp<ClipObj>(x, nullptr, min, max)->getOutput(); },
+                py::arg("x"), py::arg("min") = py::none(),
+                py::arg("max") = py::none())
+            .def("concat", [](const Graph &g, const TensorVec &inputs, int dim)
+                 { return g->addOp<ConcatObj>(inputs, nullptr, dim)->getOutput(); })
+            .def("transpose", [](const Graph &g, Tensor x, const Shape &perm)
+                 { return g->addOp<TransposeObj>(x, nullptr, perm)->getOutput(); })
+            .def("reshape", [](const Graph &g, Tensor x, const Shape &shape)
+                 { return g->addOp<ReshapeObj>(x, nullptr, shape)->getOutput(); })
+            .def("flatten", [](const Graph &g, Tensor x, int axis)
+                 { return g->addOp<FlattenObj>(x, nullptr, axis)->getOutput(); })
+            .def("squeeze", [](const Graph &g, Tensor x, const vector<int> &axes)
+                 { return g->addOp<SqueezeObj>(x, nullptr, axes)->getOutput(); })
+            .def("unsqueeze",
+                 [](const Graph &g, Tensor x, const vector<int> &axes)
+                 {
+                     return g->addOp<UnsqueezeObj>(x, nullptr, axes)
+                         ->getOutput();
+                 })
+            .def("__str__", &GraphObj::toString);
+
+        py::class_<ExecutionContextObj, ExecutionContext>(m, "ExecutionContext")
+            .def(py::init<const Graph &>(), py::arg("graph"))
+            .def_property_readonly("graph", &ExecutionContextObj::getSource)
+            .def("tensor", &ExecutionContextObj::getTensor, py::arg("tensor"),
+                 "The clone of a tensor of the graph in this context.")
+            .def(
+                "bind",
+                [](ExecutionContextObj &ctx, const Tensor &tensor,
+                   const py::buffer &buffer)
+                {
+                    auto info = request(tensor, buffer);
+                    ctx.bind(tensor, info->ptr, info);
+                },
+                py::arg("tensor"), py::arg("buffer"));
+    }
+} // namespace infini
+
+PYBIND11_MODULE(backend, m)
+{
+    infini::export_classes(m);
+    infini::export_functions(m);
+}
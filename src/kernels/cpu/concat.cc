@@ -1,5 +1,6 @@
 #include "operators/concat.h"
 #include "core/kernel.h"
+#include "utils/operator_utils.h"
 
 namespace infini {
 
@@ -32,11 +33,34 @@ class NaiveConcat : public CpuKernelWithoutConfig {
             auto inSize = input->size();
             auto inPtr = input->getRawDataPtr<T *>(),
                  outPtr = output->getRawDataPtr<T *>();
+            // Inputs may be strided views on the memory of other tensors.
+            auto contiguous = input->isContiguous();
+            // GraphObj::dataMalloc may have placed the input in its slice of
+            // the output already, then the producer has done the copy.
+            if (contiguous && inSize == localBlockOffset &&
+                inPtr == outPtr + innerOffset)
+                continue;
+            auto iStride = input->getStride();
+            // Out-of-core runtimes stream the input tile by tile and read the
+            // next tile ahead.
+            size_t tile = context->getTileBytes()
+                              ? std::max<size_t>(context->getTileBytes() / sizeof(T), 1)
+                              : inSize;
+            for (size_t begin = 0; begin < inSize; begin += tile) {
+                size_t end = std::min(inSize, begin + tile);
+                if (contiguous)
+                    context->prefetch(inPtr + end,
+                                      std::min(inSize - end, tile) * sizeof(T));
 #pragma omp parallel for
-            for (size_t iOffset = 0; iOffset < inSize; ++iOffset) {
-                auto oOffset = iOffset % localBlockOffset + innerOffset +
-                               iOffset / localBlockOffset * blockOffset;
-                outPtr[oOffset] = inPtr[iOffset];
+                for (size_t iOffset = begin; iOffset < end; ++iOffset) {
+                    auto oOffset = iOffset % localBlockOffset + innerOffset +
+                                   iOffset / localBlockOffset * blockOffset;
+                    outPtr[oOffset] =
+                        contiguous
+                            ? inPtr[iOffset]
+                            : inPtr[delocate_index(locate_index(iOffset, iDim),
+                                                   iDim, iStride)];
+                }
             }
         }
     }
@@ -37,6 +37,8 @@ namespace infini
             T *inptr0 = op->getInputs(0)->getRawDataPtr<T *>();
             T *inptr1 = op->getInputs(1)->getRawDataPtr<T *>();
             T *outptr = op->getOutput()->getRawDataPtr<T *>();
+            // outptr may equal an input of the same shape when dataMalloc
+            // runs the op in place; element i is read before it is written.
 
             auto shapeA = op->getInputs(0)->getDims();
             auto shapeB = op->getInputs(1)->getDims();
@@ -48,19 +50,18 @@ namespace infini
                       a.begin() + (rank - shapeA.size()));
             std::copy(shapeB.begin(), shapeB.end(),
                       b.begin() + (rank - shapeB.size()));
-            auto getStride = [&](const Shape &shape)
+            // Inputs may be strided views; broadcast dimensions are read with
+            // a zero stride.
+            auto getStride = [&](const Tensor &tensor)
             {
-                int p = 1;
-                Shape stride(rank);
-                for (auto i = rank; i > 0; --i)
-                {
-                    stride[i - 1] = p;
-                    p = p * shape[i - 1];
-                }
-                return stride;
+                auto stride = tensor->getStride();
+                Shape ret(rank, 0);
+                std::copy(stride.begin(), stride.end(),
+                          ret.begin() + (rank - stride.size()));
+                return ret;
             };
-            Shape strideA = getStride(a);
-            Shape strideB = getStride(b);
+            Shape strideA = getStride(op->getInputs(0));
+            Shape strideB = getStride(op->getInputs(1));
 
             auto n = op->getOutput()->size();
             T (*_doCompute)
@@ -83,12 +84,134 @@ namespace infini
                 IT_TODO_HALT();
             }
 
-            for (size_t i = 0; i < n; ++i)
+            // Out-of-core runtimes stream the operands tile by tile and read
+            // the next tile of the contiguous full-size ones ahead.
+            size_t tile = context->getTileBytes()
+                              ? std::max<size_t>(context->getTileBytes() / sizeof(T), 1)
+                              : n;
+            for (size_t begin = 0; begin < n; begin += tile)
+            {
+                size_t end = std::min(n, begin + tile);
+                size_t next = std::min(n - end, tile) * sizeof(T);
+                for (const auto &input : op->getInputs())
+                    if (input->size() == n && input->isContiguous())
+                        context->prefetch(input->getRawDataPtr<T *>() + end, next);
+                context->prefetch(outptr + end, next);
+
+#pragma omp parallel for schedule(static)
+                for (size_t i = begin; i < end; ++i)
+                {
+                    auto shapeIndexC = locate_index(i, shapeC);
+                    auto indexA = delocate_index(shapeIndexC, a, strideA);
+                    auto indexB = delocate_index(shapeIndexC, b, strideB);
+                    outptr[i] = _doCompute(inptr0[indexA], inptr1[indexB]);
+                }
+            }
+        }
+
+        // Resolved operands of a replayed op. 'indexA' and 'indexB' hold the
+        // offset of the operand element of each output element, they are
+        // empty when both inputs are contiguous and of the output's shape.
+        template <typename T>
+        struct ReplayArgs
+        {
+            const T *a, *b;
+            T *c;
+            size_t n;
+            vector<size_t> indexA, indexB;
+        };
+
+        template <typename T, T (*op)(T, T)>
+        static void replay(const void *_args)
+        {
+            auto args = static_cast<const ReplayArgs<T> *>(_args);
+            const T *a = args->a, *b = args->b;
+            T *c = args->c;
+            if (args->indexA.empty())
+            {
+                for (size_t i = 0; i < args->n; ++i)
+                    c[i] = op(a[i], b[i]);
+                return;
+            }
+            const size_t *indexA = args->indexA.data(),
+                         *indexB = args->indexB.data();
+            for (size_t i = 0; i < args->n; ++i)
+                c[i] = op(a[indexA[i]], b[indexB[i]]);
+        }
+
+        template <typename T>
+        Launch doCapture(const Operator &_op, const RuntimeObj *context) const
+        {
+            // Tiled runs stream from out-of-core memory, keep them as they are.
+            if (context->getTileBytes())
+                return Kernel::capture(_op, context);
+            auto op = as<ElementWiseObj>(_op);
+            auto args = std::make_shared<ReplayArgs<T>>();
+            args->a = op->getInputs(0)->getRawDataPtr<T *>();
+            args->b = op->getInputs(1)->getRawDataPtr<T *>();
+            args->c = op->getOutput()->getRawDataPtr<T *>();
+            args->n = op->getOutput()->size();
+
+            auto shapeC = op->getOutput()->getDims();
+            bool direct = true;
+            for (const auto &input : op->getInputs())
+                direct = direct && input->getDims() == shapeC &&
+                         input->isContiguous();
+            if (!direct)
+            {
+                auto rank = shapeC.size();
+                auto index = [&](const Tensor &input)
+                {
+                    // Broadcast dimensions are read with a zero stride.
+                    auto dims = input->getDims();
+                    auto stride = input->getStride();
+                    Shape shape(rank, 1), padded(rank, 0);
+                    std::copy(dims.begin(), dims.end(),
+                              shape.begin() + (rank - dims.size()));
+                    std::copy(stride.begin(), stride.end(),
+                              padded.begin() + (rank - stride.size()));
+                    vector<size_t> ret(args->n);
+                    for (size_t i = 0; i < args->n; ++i)
+                        ret[i] = delocate_index(locate_index(i, shapeC), shape,
+                                                padded);
+                    return ret;
+                };
+                args->indexA = index(op->getInputs(0));
+                args->indexB = index(op->getInputs(1));
+            }
+
+            void (*fn)(const void *);
+            switch (op->getOpType().underlying())
             {
-                auto shapeIndexC = locate_index(i, shapeC);
-                auto indexA = delocate_index(shapeIndexC, a, strideA);
-                auto indexB = delocate_index(shapeIndexC, b, strideB);
-                outptr[i] = _doCompute(inptr0[indexA], inptr1[indexB]);
+            case OpType::Add:
+                fn = replay<T, addCompute<T>>;
+                break;
+            case OpType::Sub:
+                fn = replay<T, subCompute<T>>;
+                break;
+            case OpType::Mul:
+                fn = replay<T, mulCompute<T>>;
+                break;
+            case OpType::Div:
+                fn = replay<T, divCompute<T>>;
+                break;
+            default:
+                return Kernel::capture(_op, context);
+            }
+            return {fn, args};
+        }
+
+        Launch capture(const Operator &_op,
+                       const RuntimeObj *context) const override
+        {
+            switch (_op->getDType().getIndex())
+            {
+            case 1: // DataType::Float32
+                return doCapture<DT<1>::t>(_op, context);
+            case 12: // DataType::UInt32
+                return doCapture<DT<12>::t>(_op, context);
+            default:
+                return Kernel::capture(_op, context);
             }
         }
 
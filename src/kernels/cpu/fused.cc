@@ -0,0 +1,46 @@
+#include "operators/fused.h"
+#include "core/kernel.h"
+
+namespace infini
+{
+    class FusedElementWise : public CpuKernelWithoutConfig
+    {
+        struct ReplayArgs
+        {
+            FusedElementWiseObj::Function function;
+            vector<const void *> inputs;
+            void *output;
+        };
+
+        static ReplayArgs resolve(const Operator &_op)
+        {
+            auto op = as<FusedElementWiseObj>(_op);
+            ReplayArgs args{op->getFunction(), {},
+                            op->getOutput()->getRawDataPtr<void *>()};
+            for (const auto &input : op->getInputs())
+                args.inputs.emplace_back(input->getRawDataPtr<void *>());
+            return args;
+        }
+
+        void compute(const Operator &_op,
+                     const RuntimeObj *context) const override
+        {
+            auto args = resolve(_op);
+            args.function(args.inputs.data(), args.output);
+        }
+
+        Launch capture(const Operator &_op,
+                       const RuntimeObj *context) const override
+        {
+            return {[](const void *_args)
+                    {
+                        auto args = static_cast<const ReplayArgs *>(_args);
+                        args->function(args->inputs.data(), args->output);
+                    },
+                    std::make_shared<ReplayArgs>(resolve(_op))};
+        }
+    };
+
+    REGISTER_KERNEL(Device::CPU, OpType::FusedElementWise, FusedElementWise,
+                    "FusedElementWise_CPU");
+}; // namespace infini
@@ -0,0 +1,54 @@
+#include "operators/reshape.h"
+#include "core/kernel.h"
+
+namespace infini
+{
+    class NativeReshape : public CpuKernelWithoutConfig
+    {
+        void compute(const Operator &_op,
+                     const RuntimeObj *context) const override
+        {
+            auto input = _op->getInputs(0), output = _op->getOutput();
+            auto inptr = input->getRawDataPtr<void *>();
+            auto outptr = output->getRawDataPtr<void *>();
+            // GraphObj::dataMalloc binds the output to the input's blob, so
+            // there is nothing to move unless the tensors were bound apart.
+            if (inptr == outptr)
+                return;
+            std::memcpy(outptr, inptr, input->getBytes());
+        }
+
+        struct ReplayArgs
+        {
+            const void *in;
+            void *out;
+            size_t bytes;
+        };
+
+        Launch capture(const Operator &_op,
+                       const RuntimeObj *context) const override
+        {
+            auto input = _op->getInputs(0), output = _op->getOutput();
+            auto inptr = input->getRawDataPtr<void *>();
+            auto outptr = output->getRawDataPtr<void *>();
+            if (inptr == outptr)
+                return {};
+            return {[](const void *_args)
+                    {
+                        auto args = static_cast<const ReplayArgs *>(_args);
+                        std::memcpy(args->out, args->in, args->bytes);
+                    },
+                    std::make_shared<ReplayArgs>(
+                        ReplayArgs{inptr, outptr, input->getBytes()})};
+        }
+    };
+
+    REGISTER_KERNEL(Device::CPU, OpType::Reshape, NativeReshape,
+                    "reshapeNaive_CPU");
+    REGISTER_KERNEL(Device::CPU, OpType::Flatten, NativeReshape,
+                    "flattenNaive_CPU");
+    REGISTER_KERNEL(Device::CPU, OpType::Squeeze, NativeReshape,
+                    "squeezeNaive_CPU");
+    REGISTER_KERNEL(Device::CPU, OpType::Unsqueeze, NativeReshape,
+                    "unsqueezeNaive_CPU");
+}; // namespace infini
@@ -25,14 +25,36 @@ class NaiveTranspose : public CpuKernelWithoutConfig {
         size_t inSize = inputs[0]->size();
         auto inPtr = inputs[0]->getRawDataPtr<T *>(),
              outPtr = outputs[0]->getRawDataPtr<T *>();
-        // #pragma omp parallel for
-        for (size_t inIdx = 0; inIdx < inSize; ++inIdx) {
-            auto posInput = idx2Pos(inDim, inIdx);
-            int outIdx = 0;
-            for (size_t j = 0, jEnd = perm.size(); j < jEnd; ++j) {
-                outIdx = outIdx * inDim[perm[j]] + posInput[perm[j]];
+        // The output is a strided view on the input, see GraphObj::optimize.
+        if (outputs[0]->isView())
+            return;
+        const auto &inStride = inputs[0]->getStride();
+        bool contiguous = inputs[0]->isContiguous();
+        // Out-of-core runtimes stream the input tile by tile and read the
+        // next tile ahead. Writes to the output are scattered.
+        size_t tile = context->getTileBytes()
+                          ? std::max<size_t>(context->getTileBytes() / sizeof(T), 1)
+                          : inSize;
+        for (size_t begin = 0; begin < inSize; begin += tile) {
+            size_t end = std::min(inSize, begin + tile);
+            if (contiguous)
+                context->prefetch(inPtr + end,
+                                  std::min(inSize - end, tile) * sizeof(T));
+#pragma omp parallel for schedule(static)
+            for (size_t inIdx = begin; inIdx < end; ++inIdx) {
+                auto posInput = idx2Pos(inDim, inIdx);
+                int outIdx = 0;
+                for (size_t j = 0, jEnd = perm.size(); j < jEnd; ++j) {
+                    outIdx = outIdx * inDim[perm[j]] + posInput[perm[j]];
+                }
+                size_t inOffset = inIdx;
+                if (!contiguous) {
+                    inOffset = 0;
+                    for (size_t j = 0, jEnd = inDim.size(); j < jEnd; ++j)
+                        inOffset += posInput[j] * inStride[j];
+                }
+                outPtr[outIdx] = inPtr[inOffset];
             }
-            outPtr[outIdx] = inPtr[inIdx];
         }
     }
 
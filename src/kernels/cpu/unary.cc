@@ -1,8 +1,23 @@
 #include "operators/unary.h"
 #include "core/kernel.h"
+#include "utils/operator_utils.h"
 
 namespace infini
 {
+    namespace
+    {
+        // The offset in 'input' of each element of a contiguous tensor of
+        // shape 'dims' that reads it.
+        vector<size_t> gatherIndex(const Tensor &input, const Shape &dims)
+        {
+            auto stride = input->getStride();
+            vector<size_t> ret(input->size());
+            for (size_t i = 0; i < ret.size(); ++i)
+                ret[i] = delocate_index(locate_index(i, dims), dims, stride);
+            return ret;
+        }
+    } // namespace
+
     class NativeUnary : public CpuKernelWithoutConfig
     {
         template <typename T>
@@ -17,6 +32,7 @@ namespace infini
             auto op = as<UnaryObj>(_op);
             T *inptr = op->getInputs(0)->getRawDataPtr<T *>();
             T *outptr = op->getOutput()->getRawDataPtr<T *>();
+            // outptr may equal inptr when dataMalloc runs the op in place.
 
             auto outDim = op->getOutput()->getDims();
             auto n = op->getOutput()->size();
@@ -32,9 +48,95 @@ namespace infini
                 IT_TODO_HALT();
             }
 
-            for (size_t offset = 0; offset < n; offset++)
+            auto input = op->getInputs(0);
+            bool contiguous = input->isContiguous();
+            auto stride = input->getStride();
+            // Out-of-core runtimes stream the operands tile by tile, as the
+            // element-wise kernels do.
+            size_t tile = context->getTileBytes()
+                              ? std::max<size_t>(context->getTileBytes() / sizeof(T), 1)
+                              : n;
+            for (size_t begin = 0; begin < n; begin += tile)
             {
-                outptr[offset] = _doCompute(inptr[offset]);
+                size_t end = std::min(n, begin + tile);
+                size_t next = std::min(n - end, tile) * sizeof(T);
+                if (contiguous)
+                    context->prefetch(inptr + end, next);
+                context->prefetch(outptr + end, next);
+
+                if (contiguous)
+                {
+#pragma omp parallel for schedule(static)
+                    for (size_t offset = begin; offset < end; offset++)
+                        outptr[offset] = _doCompute(inptr[offset]);
+                    continue;
+                }
+#pragma omp parallel for schedule(static)
+                for (size_t offset = begin; offset < end; offset++)
+                {
+                    auto index = delocate_index(locate_index(offset, outDim),
+                                                outDim, stride);
+                    outptr[offset] = _doCompute(inptr[index]);
+                }
+            }
+        }
+
+        // Resolved operands of a replayed op. 'index' holds the offset of
+        // the input element of each output element, it is empty when the
+        // input is contiguous.
+        template <typename T>
+        struct ReplayArgs
+        {
+            const T *in;
+            T *out;
+            size_t n;
+            vector<size_t> index;
+        };
+
+        template <typename T, T (*op)(T)>
+        static void replay(const void *_args)
+        {
+            auto args = static_cast<const ReplayArgs<T> *>(_args);
+            const T *in = args->in;
+            T *out = args->out;
+            if (args->index.empty())
+            {
+                for (size_t i = 0; i < args->n; ++i)
+                    out[i] = op(in[i]);
+                return;
+            }
+            const size_t *index = args->index.data();
+            for (size_t i = 0; i < args->n; ++i)
+                out[i] = op(in[index[i]]);
+        }
+
+        template <typename T>
+        Launch doCapture(const Operator &_op, const RuntimeObj *context) const
+        {
+            // Tiled runs stream from out-of-core memory, keep them as they are.
+            if (_op->getOpType() != OpType::Relu || context->getTileBytes())
+                return Kernel::capture(_op, context);
+            auto input = _op->getInputs(0), output = _op->getOutput();
+            auto args = std::make_shared<ReplayArgs<T>>();
+            args->in = input->getRawDataPtr<T *>();
+            args->out = output->getRawDataPtr<T *>();
+            args->n = output->size();
+            if (!input->isContiguous())
+                args->index = gatherIndex(input, output->getDims());
+            return {replay<T, reluCompute<T>>, args};
+        }
+
+        Launch capture(const Operator &_op,
+                       const RuntimeObj *context) const override
+        {
+            switch (_op->getDType().getIndex())
+            {
+            case 1: // DataType::Float32
+                return doCapture<DT<1>::t>(_op, context);
+            case 12: // DataType::UInt32
+                return doCapture<DT<12>::t>(_op, context);
+            default:
+                return Kernel::capture(_op, context);
             }
         }
 
@@ -66,16 +168,103 @@ namespace infini
             auto op = as<ClipObj>(_op);
             T *inptr = op->getInputs(0)->getRawDataPtr<T *>();
             T *outptr = op->getOutput()->getRawDataPtr<T *>();
+            // outptr may equal inptr when dataMalloc runs the op in place.
             auto minValue = op->getMin();
             auto maxValue = op->getMax();
 
             auto n = op->getOutput()->size();
-            for (size_t offset = 0; offset < n; offset++)
+            auto input = op->getInputs(0);
+            auto outDim = op->getOutput()->getDims();
+            auto stride = input->getStride();
+            bool contiguous = input->isContiguous();
+            // Tiled and prefetched as NativeUnary does.
+            size_t tile = context->getTileBytes()
+                              ? std::max<size_t>(context->getTileBytes() / sizeof(T), 1)
+                              : n;
+            for (size_t begin = 0; begin < n; begin += tile)
+            {
+                size_t end = std::min(n, begin + tile);
+                size_t next = std::min(n - end, tile) * sizeof(T);
+                if (contiguous)
+                    context->prefetch(inptr + end, next);
+                context->prefetch(outptr + end, next);
+
+#pragma omp parallel for schedule(static)
+                for (size_t offset = begin; offset < end; offset++)
+                {
+                    auto val = contiguous
+                                   ? inptr[offset]
+                                   : inptr[delocate_index(locate_index(offset, outDim),
+                                                          outDim, stride)];
+                    outptr[offset] = (minValue && val < *minValue)   ? *minValue
+                                     : (maxValue && val > *maxValue) ? *maxValue
+                                                                     : val;
+                }
+            }
+        }
+
+        // Resolved operands of a replayed op, see NativeUnary::ReplayArgs.
+        // Absent bounds are infinite: like compute, they leave every value,
+        // infinities included, unchanged.
+        template <typename T>
+        struct ReplayArgs
+        {
+            const T *in;
+            T *out;
+            size_t n;
+            vector<size_t> index;
+            T lo, hi;
+        };
+
+        template <typename T>
+        static void replay(const void *_args)
+        {
+            auto args = static_cast<const ReplayArgs<T> *>(_args);
+            const T *in = args->in;
+            T *out = args->out;
+            const T lo = args->lo, hi = args->hi;
+            const size_t *index =
+                args->index.empty() ? nullptr : args->index.data();
+            for (size_t i = 0; i < args->n; ++i)
             {
-                auto val = *inptr++;
-                *outptr++ = (minValue && val < *minValue)   ? *minValue
-                            : (maxValue && val > *maxValue) ? *maxValue
-                                                            : val;
+                auto val = index ? in[index[i]] : in[i];
+                out[i] = val < lo ? lo : val > hi ? hi : val;
+            }
+        }
+
+        template <typename T>
+        Launch doCapture(const Operator &_op, const RuntimeObj *context) const
+        {
+            // Bounds are floats, compared as compute does for other types.
+            if constexpr (!std::is_floating_point_v<T>)
+                return Kernel::capture(_op, context);
+            if (context->getTileBytes())
+                return Kernel::capture(_op, context);
+            auto op = as<ClipObj>(_op);
+            auto input = op->getInputs(0), output = op->getOutput();
+            auto args = std::make_shared<ReplayArgs<T>>();
+            args->in = input->getRawDataPtr<T *>();
+            args->out = output->getRawDataPtr<T *>();
+            args->n = output->size();
+            if (!input->isContiguous())
+                args->index = gatherIndex(input, output->getDims());
+            auto minValue = op->getMin(), maxValue = op->getMax();
+            args->lo = minValue ? T(*minValue) : -std::numeric_limits<T>::infinity();
+            args->hi = maxValue ? T(*maxValue) : std::numeric_limits<T>::infinity();
+            return {replay<T>, args};
+        }
+
+        Launch capture(const Operator &_op,
+                       const RuntimeObj *context) const override
+        {
+            switch (_op->getDType().getIndex())
+            {
+            case 1: // DataType::Float32
+                return doCapture<DT<1>::t>(_op, context);
+            case 12: // DataType::UInt32
+                return doCapture<DT<12>::t>(_op, context);
+            default:
+                return Kernel::capture(_op, context);
             }
         }
 
@@ -0,0 +1,41 @@
+#include "operators/fused.h"
+#include "utils/operator_utils.h"
+
+namespace infini
+{
+    FusedElementWiseObj::FusedElementWiseObj(GraphObj *graph, TensorVec inputs,
+                                             Tensor output, string description,
+                                             Function function,
+                                             Ref<void> library)
+        : OperatorObj(OpType::FusedElementWise, std::move(inputs), {output}),
+          description(std::move(description)), function(function),
+          library(std::move(library))
+    {
+        IT_ASSERT(function != nullptr);
+        IT_ASSERT(checkValid(graph));
+    }
+
+    optional<vector<Shape>>
+    FusedElementWiseObj::inferShape(const TensorVec &inputs)
+    {
+        // Every operator of the region broadcasts its inputs, so the output
+        // is the broadcast of all of them.
+        Shape ret = inputs[0]->getDims();
+        for (const auto &input : inputs)
+            ret = infer_broadcast(ret, input->getDims());
+        return {{ret}};
+    }
+
+    std::string FusedElementWiseObj::toString() const
+    {
+        std::ostringstream os;
+        os << type.toString() << "[" << getGuid() << "]";
+        os << "(" << description << ",";
+        os << vecToString(outputs[0]->getDims()) << ",";
+        os << "inputs=";
+        for (const auto &input : inputs)
+            os << input->getGuid() << ",";
+        os << "output=" << outputs[0]->getGuid() << ")";
+        return os.str();
+    }
+}; // namespace infini
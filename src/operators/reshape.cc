@@ -0,0 +1,187 @@
+#include "operators/reshape.h"
+#include "utils/operator_utils.h"
+
+namespace infini
+{
+    ReshapeObj::ReshapeObj(GraphObj *graph, Tensor input, Tensor output,
+                           Shape dims)
+        : OperatorObj(OpType::Reshape, {input}, {output}), dims(std::move(dims))
+    {
+        IT_ASSERT(checkValid(graph));
+    }
+
+    optional<vector<Shape>> ReshapeObj::inferShape(const TensorVec &inputs)
+    {
+        const auto A = inputs[0];
+        auto input_dim = A->getDims();
+        Shape output_dim = dims;
+
+        int inferIdx = -1;
+        size_t known = 1;
+        for (size_t i = 0; i < output_dim.size(); ++i)
+        {
+            if (output_dim[i] == 0)
+            {
+                if (i >= input_dim.size())
+                    return std::nullopt;
+                output_dim[i] = input_dim[i];
+            }
+            if (output_dim[i] == -1)
+            {
+                if (inferIdx != -1)
+                    return std::nullopt; // only one dimension can be inferred
+                inferIdx = i;
+                continue;
+            }
+            if (output_dim[i] < 0)
+                return std::nullopt;
+            known *= output_dim[i];
+        }
+
+        if (inferIdx != -1)
+        {
+            if (known == 0 || A->size() % known != 0)
+                return std::nullopt;
+            output_dim[inferIdx] = A->size() / known;
+        }
+        else if (known != A->size())
+        {
+            return std::nullopt;
+        }
+
+        return {{output_dim}};
+    }
+
+    std::string ReshapeObj::toString() const
+    {
+        std::ostringstream os;
+        os << type.toString() << "[" << getGuid() << "]";
+        os << "(";
+        os << vecToString(inputs[0]->getDims()) << ",";
+        os << "dims=" << vecToString(dims) << ",";
+        os << "input=" << inputs[0]->getGuid() << ",";
+        os << "output=" << outputs[0]->getGuid() << ")";
+        return os.str();
+    }
+
+    FlattenObj::FlattenObj(GraphObj *graph, Tensor input, Tensor output,
+                           int _axis)
+        : OperatorObj(OpType::Flatten, {input}, {output})
+    {
+        int rank = input->getRank();
+        // Flatten accepts axis == rank, which get_real_axis would reject.
+        IT_ASSERT(_axis >= -rank && _axis <= rank);
+        axis = _axis < 0 ? _axis + rank : _axis;
+        IT_ASSERT(checkValid(graph));
+    }
+
+    optional<vector<Shape>> FlattenObj::inferShape(const TensorVec &inputs)
+    {
+        const auto A = inputs[0];
+        auto input_dim = A->getDims();
+        int outer = std::accumulate(input_dim.begin(), input_dim.begin() + axis,
+                                    1, std::multiplies<int>());
+        int inner = std::accumulate(input_dim.begin() + axis, input_dim.end(), 1,
+                                    std::multiplies<int>());
+        return {{{outer, inner}}};
+    }
+
+    std::string FlattenObj::toString() const
+    {
+        std::ostringstream os;
+        os << type.toString() << "[" << getGuid() << "]";
+        os << "(";
+        os << vecToString(inputs[0]->getDims()) << ",";
+        os << "axis=" << axis << ",";
+        os << "input=" << inputs[0]->getGuid() << ",";
+        os << "output=" << outputs[0]->getGuid() << ")";
+        return os.str();
+    }
+
+    SqueezeObj::SqueezeObj(GraphObj *graph, Tensor input, Tensor output,
+                           vector<int> _axes)
+        : OperatorObj(OpType::Squeeze, {input}, {output})
+    {
+        int rank = input->getRank();
+        for (auto axis : _axes)
+            axes.emplace_back(get_real_axis(axis, rank));
+        IT_ASSERT(checkValid(graph));
+    }
+
+    optional<vector<Shape>> SqueezeObj::inferShape(const TensorVec &inputs)
+    {
+        const auto A = inputs[0];
+        auto input_dim = A->getDims();
+        Shape output_dim;
+
+        for (size_t i = 0; i < input_dim.size(); ++i)
+        {
+            bool selected = axes.empty()
+                                ? input_dim[i] == 1
+                                : std::find(axes.begin(), axes.end(), int(i)) !=
+                                      axes.end();
+            if (!selected)
+                output_dim.emplace_back(input_dim[i]);
+            else if (input_dim[i] != 1)
+                return std::nullopt; // only dimensions of size 1 can be removed
+        }
+
+        return {{output_dim}};
+    }
+
+    std::string SqueezeObj::toString() const
+    {
+        std::ostringstream os;
+        os << type.toString() << "[" << getGuid() << "]";
+        os << "(";
+        os << vecToString(inputs[0]->getDims()) << ",";
+        os << "axes=" << vecToString(axes) << ",";
+        os << "input=" << inputs[0]->getGuid() << ",";
+        os << "output=" << outputs[0]->getGuid() << ")";
+        return os.str();
+    }
+
+    UnsqueezeObj::UnsqueezeObj(GraphObj *graph, Tensor input, Tensor output,
+                               vector<int> _axes)
+        : OperatorObj(OpType::Unsqueeze, {input}, {output})
+    {
+        // Axes index the output, whose rank includes the inserted dimensions.
+        int rank = input->getRank() + _axes.size();
+        for (auto axis : _axes)
+            axes.emplace_back(get_real_axis(axis, rank));
+        IT_ASSERT(checkValid(graph));
+    }
+
+    optional<vector<Shape>> UnsqueezeObj::inferShape(const TensorVec &inputs)
+    {
+        const auto A = inputs[0];
+        auto input_dim = A->getDims();
+        size_t rank = input_dim.size() + axes.size();
+        Shape output_dim(rank, 0);
+
+        for (auto axis : axes)
+        {
+            if (output_dim[axis] == 1)
+                return std::nullopt; // duplicated axis
+            output_dim[axis] = 1;
+        }
+        auto it = input_dim.begin();
+        for (auto &d : output_dim)
+            if (d == 0)
+                d = *it++;
+
+        return {{output_dim}};
+    }
+
+    std::string UnsqueezeObj::toString() const
+    {
+        std::ostringstream os;
+        os << type.toString() << "[" << getGuid() << "]";
+        os << "(";
+        os << vecToString(inputs[0]->getDims()) << ",";
+        os << "axes=" << vecToString(axes) << ",";
+        os << "input=" << inputs[0]->getGuid() << ",";
+        os << "output=" << outputs[0]->getGuid() << ")";
+        return os.str();
+    }
+}; // namespace infini
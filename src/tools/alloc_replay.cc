@@ -0,0 +1,47 @@
+// Replay an allocation trace, recorded with GraphObj::recordAllocTrace and
+// AllocTrace::save, against every allocation strategy.
+//
+// usage: alloc_replay <trace> [alignment]
+#include "core/allocator.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace infini;
+
+int main(int argc, char **argv)
+{
+    if (argc < 2 || argc > 3)
+    {
+        std::fprintf(stderr, "usage: %s <trace> [alignment]\n", argv[0]);
+        return 1;
+    }
+    auto trace = AllocTrace::load(argv[1]);
+    size_t alignment =
+        argc == 3 ? std::strtoull(argv[2], nullptr, 0) : trace.getAlignment();
+    std::printf("%zu events, alignment %zu\n", trace.getEvents().size(),
+                alignment);
+
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    vector<Ref<AllocStrategy>> strategies{
+        make_ref<FirstFitStrategy>(), make_ref<BestFitStrategy>(),
+        make_ref<WorstFitStrategy>(), make_ref<SizeClassStrategy>()};
+    std::printf("%-10s %14s %14s %8s %12s %10s\n", "strategy", "peak",
+                "lower bound", "wasted", "free blocks", "time (ms)");
+    for (const auto &strategy : strategies)
+    {
+        Allocator allocator(runtime, alignment);
+        allocator.setStrategy(strategy);
+        auto begin = std::chrono::steady_clock::now();
+        size_t peak = trace.replay(allocator);
+        double ms = std::chrono::duration<double, std::milli>(
+                        std::chrono::steady_clock::now() - begin)
+                        .count();
+        size_t bound = allocator.getLowerBound();
+        std::printf("%-10s %14zu %14zu %7.2f%% %12zu %10.3f\n",
+                    strategy->toString().c_str(), peak, bound,
+                    peak ? 100.0 * (peak - bound) / peak : 0.0,
+                    allocator.getFreeBlockCount(), ms);
+    }
+    return 0;
+}
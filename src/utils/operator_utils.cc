@@ -80,6 +80,16 @@ size_t delocate_index(const Shape &shapeIndex, const Shape &shape,
     return ans;
 }
 
+Shape get_contiguous_stride(const Shape &shape) {
+    Shape stride(shape.size());
+    int p = 1;
+    for (size_t i = shape.size(); i > 0; --i) {
+        stride[i - 1] = p;
+        p *= shape[i - 1];
+    }
+    return stride;
+}
+
 std::string device_to_str(Device device) {
     std::string deviceStr;
     switch (device) {
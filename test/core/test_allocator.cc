@@ -4,6 +4,7 @@
 #include "operators/unary.h"
 
 #include "test.h"
+#include <random>
 
 namespace infini
 {
@@ -71,4 +72,140 @@ namespace infini
         EXPECT_EQ(ptr1, ptr2);
     }
 
+    TEST(Allocator, testAllocAfterFreeBelowEnd)
+    {
+        Shape shape = Shape{1, 2, 2, 3};
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Tensor a = make_ref<TensorObj>(shape, DataType::Float32, runtime);
+        Tensor b = make_ref<TensorObj>(shape, DataType::Float32, runtime);
+        Tensor c =
+            make_ref<TensorObj>(Shape{2, 2, 2, 3}, DataType::Float32, runtime);
+        Allocator allocator = Allocator(runtime);
+        // allocate a->b, free a, then allocate c which does not fit in a
+        size_t offsetA = allocator.alloc(a->getBytes());
+        size_t offsetB = allocator.alloc(b->getBytes());
+        allocator.free(offsetA, a->getBytes());
+        size_t offsetC = allocator.alloc(c->getBytes());
+        // c must be placed after b instead of overlapping it
+        EXPECT_GE(offsetC, offsetB + b->getBytes());
+    }
+
+    TEST(Allocator, testAlignment)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Allocator allocator = Allocator(runtime);
+        size_t offsetA = allocator.alloc(12);
+        size_t offsetB = allocator.alloc(100);
+        size_t offsetC = allocator.alloc(4 << 20);
+        EXPECT_EQ(offsetA % Allocator::defaultAlignment, 0u);
+        EXPECT_EQ(offsetB % Allocator::defaultAlignment, 0u);
+        EXPECT_EQ(offsetC % Allocator::defaultAlignment, 0u);
+        // large arenas start on a huge page boundary
+        void *ptr = allocator.getPtr();
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % (2 << 20), 0u);
+    }
+
+    TEST(Allocator, testStrategy)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        vector<Ref<AllocStrategy>> strategies{
+            make_ref<FirstFitStrategy>(), make_ref<BestFitStrategy>(),
+            make_ref<WorstFitStrategy>()};
+        for (size_t i = 0; i < strategies.size(); ++i)
+        {
+            Allocator allocator = Allocator(runtime);
+            allocator.setStrategy(strategies[i]);
+            // leave a 256-byte hole before a 64-byte hole
+            size_t offsetA = allocator.alloc(256);
+            allocator.alloc(64);
+            size_t offsetB = allocator.alloc(64);
+            allocator.alloc(64);
+            allocator.free(offsetA, 256);
+            allocator.free(offsetB, 64);
+            size_t offsetC = allocator.alloc(64);
+            // first fit and worst fit take the first hole, best fit the second
+            EXPECT_EQ(offsetC, i == 1 ? offsetB : offsetA);
+            EXPECT_EQ(allocator.getFreeBlockCount(), i == 1 ? 1u : 2u);
+            EXPECT_EQ(allocator.getLargestFreeBlock(), i == 1 ? 256u : 192u);
+            EXPECT_EQ(allocator.getLowerBound(), 448u);
+        }
+    }
+
+    TEST(Allocator, testFreeBlockTree)
+    {
+        // the tree agrees with a scan of the blocks in address order
+        FreeBlockTree tree;
+        std::map<size_t, size_t> blocks;
+        std::mt19937 gen(7);
+        for (int i = 0; i < 2000; ++i)
+        {
+            size_t addr = gen() % 512 * 64;
+            auto it = blocks.find(addr);
+            if (it != blocks.end())
+            {
+                tree.erase(addr);
+                blocks.erase(it);
+            }
+            else
+            {
+                size_t size = (gen() % 32 + 1) * 64;
+                tree.insert(addr, size);
+                blocks[addr] = size;
+            }
+            size_t size = (gen() % 40 + 1) * 64;
+            optional<size_t> expected;
+            for (auto [blockAddr, blockSize] : blocks)
+            {
+                if (blockSize >= size)
+                {
+                    expected = blockAddr;
+                    break;
+                }
+            }
+            EXPECT_EQ(tree.firstFit(size), expected);
+        }
+    }
+
+    TEST(Allocator, testSizeClassStrategy)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Allocator allocator = Allocator(runtime);
+        allocator.setStrategy(make_ref<SizeClassStrategy>());
+        // 320 bytes are in the 320 class, 384 in the 384 class
+        size_t offsetA = allocator.alloc(320);
+        size_t offsetB = allocator.alloc(384);
+        EXPECT_EQ(offsetB - offsetA, 320u);
+        // 1088 rounds up to the 1280 class
+        allocator.alloc(1088);
+        EXPECT_EQ(allocator.getPeak(), 320u + 384u + 1280u);
+        EXPECT_EQ(allocator.getLowerBound(), 320u + 384u + 1088u);
+    }
+
+    TEST(Allocator, testTrace)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor i0 = g->addTensor({2, 32}, DataType::Float32);
+        auto op1 = g->addOp<ReluObj>(i0, nullptr);
+        auto op2 = g->addOp<ReluObj>(op1->getOutput(), nullptr);
+        g->addOp<ReluObj>(op1->getOutput(), nullptr);
+        g->addOp<ReluObj>(op2->getOutput(), nullptr);
+        g->recordAllocTrace();
+        g->dataMalloc();
+
+        auto trace = g->getAllocTrace();
+        string path = testing::TempDir() + "alloc_trace.bin";
+        trace->save(path);
+        auto loaded = AllocTrace::load(path);
+        ASSERT_EQ(loaded.getEvents().size(), trace->getEvents().size());
+        EXPECT_EQ(loaded.getAlignment(), Allocator::defaultAlignment);
+        // the output of op1 is freed by the last operator reading it
+        for (const auto &event : loaded.getEvents())
+            EXPECT_TRUE(!event.isFree || event.tag != 0);
+
+        // replaying under the same strategy reproduces the plan
+        Allocator allocator(runtime, loaded.getAlignment());
+        EXPECT_EQ(loaded.replay(allocator), 4u * 256u);
+        EXPECT_EQ(allocator.getLowerBound(), 4u * 256u);
+    }
 } // namespace infini
@@ -0,0 +1,111 @@
+#include "core/async_runner.h"
+#include "core/runtime.h"
+#include "operators/element_wise.h"
+#include "operators/unary.h"
+
+#include "test.h"
+
+namespace infini
+{
+    namespace
+    {
+        // Relu(x + x) over 'n' floats, with x and y as its input and output.
+        std::tuple<Graph, Tensor, Tensor> doubleRelu(int n)
+        {
+            Runtime runtime = NativeCpuRuntimeObj::getInstance();
+            Graph g = make_ref<GraphObj>(runtime);
+            auto x = g->addTensor(Shape{n}, DataType::Float32);
+            auto t = g->addOp<AddObj>(x, x, nullptr)->getOutput();
+            auto y = g->addOp<ReluObj>(t, nullptr)->getOutput();
+            g->dataMalloc();
+            return {g, x, y};
+        }
+    } // namespace
+
+    TEST(AsyncRunner, Pipelining)
+    {
+        constexpr int n = 4096, requests = 64;
+        auto [g, x, y] = doubleRelu(n);
+        AsyncRunnerObj runner(g, {x}, {y}, 3, 4);
+        vector<vector<float>> in(requests, vector<float>(n)),
+            out(requests, vector<float>(n));
+        vector<std::future<void>> futures;
+        for (int r = 0; r < requests; ++r)
+        {
+            // prepared while earlier requests run
+            for (int i = 0; i < n; ++i)
+                in[r][i] = float(i % 13 - r);
+            futures.emplace_back(
+                runner.submit({in[r].data()}, {out[r].data()}).future);
+            EXPECT_LE(runner.pending(), 3u + 4u);
+        }
+        for (int r = 0; r < requests; ++r)
+        {
+            futures[r].get();
+            int failures = 0;
+            for (int i = 0; i < n; ++i)
+                failures += out[r][i] != std::max(2 * in[r][i], 0.f);
+            EXPECT_EQ(failures, 0);
+        }
+    }
+
+    TEST(AsyncRunner, Cancel)
+    {
+        constexpr int n = 1 << 20;
+        auto [g, x, y] = doubleRelu(n);
+        AsyncRunnerObj runner(g, {x}, {y}, 1, 8);
+        vector<float> in(n, 1), out(n);
+        vector<AsyncRunnerObj::Ticket> tickets;
+        for (int r = 0; r < 4; ++r)
+            tickets.emplace_back(runner.submit({in.data()}, {out.data()}));
+        // the last request is still queued behind the others on one worker
+        EXPECT_TRUE(runner.cancel(tickets.back().id));
+        EXPECT_FALSE(runner.cancel(tickets.back().id));
+        EXPECT_THROW(tickets.back().future.get(), Exception);
+        for (int r = 0; r < 3; ++r)
+            tickets[r].future.get();
+        EXPECT_FALSE(runner.cancel(tickets.front().id));
+        EXPECT_EQ(out[0], 2);
+    }
+
+    TEST(AsyncRunner, ExternalAndWeights)
+    {
+        // x and y are bound to the request's buffers, w is set after
+        // dataMalloc and lives in the arena
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        auto x = g->addTensor(Shape{2, 4}, DataType::Float32);
+        auto w = g->addTensor(Shape{1, 4}, DataType::Float32);
+        auto t = g->addOp<MulObj>(x, w, nullptr)->getOutput();
+        auto y = g->addOp<ReluObj>(t, nullptr)->getOutput();
+        g->setExternal(x);
+        g->setExternal(y);
+        g->dataMalloc();
+        w->setData(IncrementalGenerator());
+
+        AsyncRunnerObj runner(g, {x}, {y}, 2, 4);
+        vector<vector<float>> in, out(4, vector<float>(8));
+        vector<std::future<void>> futures;
+        for (int r = 0; r < 4; ++r)
+        {
+            in.emplace_back(vector<float>{1, 1, 1, 1, -1, 1, -1, 1});
+            in.back()[0] = r;
+            futures.emplace_back(
+                runner.submit({in[r].data()}, {out[r].data()}).future);
+        }
+        for (int r = 0; r < 4; ++r)
+        {
+            futures[r].get();
+            EXPECT_EQ(out[r], (vector<float>{0, 1, 2, 3, 0, 1, 0, 3}));
+        }
+    }
+
+    TEST(AsyncRunner, Unplanned)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        auto x = g->addTensor(Shape{4}, DataType::Float32);
+        auto y = g->addOp<ReluObj>(x, nullptr)->getOutput();
+        EXPECT_THROW(AsyncRunnerObj(g, {x}, {y}), Exception);
+    }
+} // namespace infini
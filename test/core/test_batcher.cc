@@ -0,0 +1,120 @@
+#include "core/batcher.h"
+#include "core/runtime.h"
+#include "operators/element_wise.h"
+#include "operators/unary.h"
+
+#include "test.h"
+#include <iostream>
+
+namespace infini
+{
+    namespace
+    {
+        constexpr int width = 256;
+
+        // Relu(x * w) with one weight row shared by every batch size.
+        BatcherObj::Builder builder(vector<float> &weight)
+        {
+            return [&weight](int batch)
+            {
+                Runtime runtime = NativeCpuRuntimeObj::getInstance();
+                Graph g = make_ref<GraphObj>(runtime);
+                auto x = g->addTensor({batch, width}, DataType::Float32);
+                auto w = g->addTensor({1, width}, DataType::Float32);
+                w->setExternalBlob(make_ref<BlobObj>(runtime, weight.data()));
+                auto t = g->addOp<MulObj>(x, w, nullptr)->getOutput();
+                auto y = g->addOp<ReluObj>(t, nullptr)->getOutput();
+                return BatchedGraph{g, {x}, {y}};
+            };
+        }
+
+        // 'clients' threads each submit 'perClient' requests back to back
+        // and check every result, returns the number of wrong results.
+        int generateLoad(BatcherObj &batcher, int clients, int perClient)
+        {
+            vector<int> failures(clients, 0);
+            vector<std::thread> threads;
+            for (int c = 0; c < clients; ++c)
+                threads.emplace_back(
+                    [&, c]()
+                    {
+                        vector<float> x(width), y(width);
+                        for (int r = 0; r < perClient; ++r)
+                        {
+                            for (int i = 0; i < width; ++i)
+                                x[i] = float(c - r + i % 7) - 3;
+                            batcher.submit({x.data()}, {y.data()}).get();
+                            for (int i = 0; i < width; ++i)
+                                failures[c] += y[i] != std::max(2 * x[i], 0.f);
+                        }
+                    });
+            for (auto &thread : threads)
+                thread.join();
+            int total = 0;
+            for (auto f : failures)
+                total += f;
+            return total;
+        }
+    } // namespace
+
+    TEST(Batcher, Results)
+    {
+        vector<float> weight(width, 2.0f);
+        BatcherObj batcher(builder(weight), 8, std::chrono::milliseconds(2));
+        EXPECT_EQ(generateLoad(batcher, 16, 20), 0);
+        auto stats = batcher.getStats();
+        EXPECT_EQ(stats.requests, 16u * 20);
+        EXPECT_LE(stats.meanBatch(), 8);
+        // concurrent clients share runs
+        EXPECT_LT(stats.batches, stats.requests);
+        EXPECT_LE(stats.percentile(0.5), stats.percentile(0.99));
+    }
+
+    TEST(Batcher, Deadline)
+    {
+        vector<float> weight(width, 2.0f);
+        BatcherObj batcher(builder(weight), 64, std::chrono::milliseconds(5));
+        // a lone request is not held back beyond the deadline
+        EXPECT_EQ(generateLoad(batcher, 1, 3), 0);
+        auto stats = batcher.getStats();
+        EXPECT_EQ(stats.batches, 3u);
+        EXPECT_GE(stats.percentile(0), 5);
+        EXPECT_LT(stats.percentile(1), 1000);
+    }
+
+    TEST(Batcher, LatencyHistogram)
+    {
+        BatcherObj::Stats stats;
+        for (int r = 0; r < 100; ++r)
+            for (int ms = 1; ms <= 1000; ++ms)
+                stats.record(ms);
+        // the stats do not grow with the requests
+        EXPECT_EQ(stats.histogram.size(), size_t(BatcherObj::Stats::nBuckets));
+        EXPECT_EQ(stats.requests, 100000u);
+        EXPECT_EQ(stats.percentile(0), 1);
+        EXPECT_EQ(stats.percentile(1), 1000);
+        EXPECT_NEAR(stats.percentile(0.5), 500, 500 * 0.045);
+        EXPECT_NEAR(stats.percentile(0.99), 990, 990 * 0.045);
+    }
+
+    TEST(Batcher, Invalid)
+    {
+        vector<float> weight(width, 2.0f);
+        BatcherObj batcher(builder(weight), 4, std::chrono::milliseconds(1));
+        vector<float> x(width), y(width);
+        EXPECT_THROW(batcher.submit({x.data()}, {}), Exception);
+    }
+
+    TEST(Batcher, Curve)
+    {
+        vector<float> weight(width, 2.0f);
+        BatcherObj batcher(builder(weight), 16, std::chrono::microseconds(500));
+        for (int clients : {1, 4, 16, 64})
+        {
+            batcher.resetStats();
+            EXPECT_EQ(generateLoad(batcher, clients, 50), 0);
+            std::cout << clients << " clients: "
+                      << batcher.getStats().toString() << std::endl;
+        }
+    }
+} // namespace infini
@@ -0,0 +1,138 @@
+#include "core/codegen.h"
+#include "core/runtime.h"
+#include "operators/concat.h"
+#include "operators/element_wise.h"
+#include "operators/matmul.h"
+#include "operators/reshape.h"
+#include "operators/transpose.h"
+#include "operators/unary.h"
+
+#include "test.h"
+#include <cstdlib>
+#include <dlfcn.h>
+
+namespace infini
+{
+    namespace
+    {
+        using Infer = void (*)(const void *, void *);
+
+        // Builds 'source' in a fresh directory and loads its entry point.
+        // The directory name needs quoting in a shell.
+        Infer build(const string &source)
+        {
+            char dir[] = "/tmp/infinitensor codegen;$(false)-XXXXXX";
+            IT_ASSERT(mkdtemp(dir) != nullptr);
+            auto library = string(dir) + "/model.so";
+            compileCpp(source, library);
+            auto handle = dlopen(library.c_str(), RTLD_NOW | RTLD_LOCAL);
+            IT_ASSERT(handle != nullptr);
+            return reinterpret_cast<Infer>(dlsym(handle, "infer"));
+        }
+    } // namespace
+
+    TEST(Codegen, MatchesRun)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        auto x = g->addTensor({4, 6}, DataType::Float32);
+        auto w = g->addTensor({1, 6}, DataType::Float32);
+        vector<float> weight = {1, -2, 3, -4, 5, -6};
+        w->setExternalBlob(make_ref<BlobObj>(runtime, weight.data()));
+        auto t0 = g->addOp<MulObj>(x, w, nullptr)->getOutput();
+        auto t1 = g->addOp<AddObj>(t0, x, nullptr)->getOutput();
+        auto t2 =
+            g->addOp<TransposeObj>(t1, nullptr, Shape{1, 0})->getOutput();
+        auto t3 = g->addOp<ClipObj>(t2, nullptr, -4.0f, 20.0f)->getOutput();
+        auto t4 = g->addOp<ReluObj>(t0, nullptr)->getOutput();
+        auto t5 = g->addOp<ReshapeObj>(t4, nullptr, Shape{6, 4})->getOutput();
+        auto t6 = g->addOp<ConcatObj>(TensorVec{t3, t5}, nullptr, 1)
+                      ->getOutput();
+        auto y = g->addOp<ReluObj>(t6, nullptr)->getOutput();
+        g->optimize();
+        g->dataMalloc();
+
+        auto source = generateCpp(g, {x}, {y});
+        auto infer = build(source);
+        ASSERT_NE(infer, nullptr);
+        vector<float> in(24), out(y->size());
+        for (int round = 0; round < 2; ++round)
+        {
+            for (size_t i = 0; i < in.size(); ++i)
+                in[i] = float(i) * 0.75f - 6 - round;
+            std::copy(in.begin(), in.end(), x->getRawDataPtr<float *>());
+            runtime->run(g);
+            infer(in.data(), out.data());
+            EXPECT_TRUE(y->equalData(out));
+        }
+    }
+
+    TEST(Codegen, WeightsInArena)
+    {
+        // weights set after dataMalloc live in the arena
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        auto x = g->addTensor({4, 6}, DataType::Float32);
+        auto w = g->addTensor({1, 6}, DataType::Float32);
+        auto b = g->addTensor({4, 6}, DataType::Float32);
+        auto t0 = g->addOp<MulObj>(x, w, nullptr)->getOutput();
+        auto t1 = g->addOp<AddObj>(t0, b, nullptr)->getOutput();
+        auto t2 = g->addOp<ReluObj>(t1, nullptr)->getOutput();
+        auto y = g->addOp<SubObj>(t2, x, nullptr)->getOutput();
+        g->dataMalloc();
+        w->setData([](void *ptr, size_t size, DataType)
+                   {
+                       auto data = static_cast<float *>(ptr);
+                       for (size_t i = 0; i < size; ++i)
+                           data[i] = float(i) - 2.5f;
+                   });
+        b->setData(IncrementalGenerator());
+
+        auto infer = build(generateCpp(g, {x}, {y}));
+        ASSERT_NE(infer, nullptr);
+        vector<float> in(24), out(y->size());
+        for (int round = 0; round < 2; ++round)
+        {
+            for (size_t i = 0; i < in.size(); ++i)
+                in[i] = float(i) * 0.5f - 3 - round;
+            std::copy(in.begin(), in.end(), x->getRawDataPtr<float *>());
+            infer(in.data(), out.data());
+            runtime->run(g);
+            EXPECT_TRUE(y->equalData(out));
+        }
+    }
+
+    TEST(Codegen, External)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        auto a = g->addTensor({2, 3}, DataType::Float32);
+        auto b = g->addTensor({2, 3}, DataType::Float32);
+        auto t = g->addOp<SubObj>(a, b, nullptr)->getOutput();
+        auto y = g->addOp<ReluObj>(t, nullptr)->getOutput();
+        vector<float> bound(6), result(6);
+        g->setExternal(a);
+        g->setExternal(y);
+        g->dataMalloc();
+        g->bind(a, bound.data());
+        g->bind(y, result.data());
+
+        // 'a' is read from and 'y' written to the caller's memory directly
+        auto infer = build(generateCpp(g, {a, b}, {y}));
+        ASSERT_NE(infer, nullptr);
+        vector<float> in = {1, 2, 3, 4, 5, 6, 6, 5, 4, 3, 2, 1}, out(6);
+        infer(in.data(), out.data());
+        EXPECT_EQ(out, (vector<float>{0, 0, 0, 1, 3, 5}));
+    }
+
+    TEST(Codegen, Unsupported)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        auto a = g->addTensor({2, 3}, DataType::Float32);
+        auto b = g->addTensor({3, 2}, DataType::Float32);
+        auto y = g->addOp<MatmulObj>(a, b, nullptr)->getOutput();
+        g->dataMalloc();
+        EXPECT_THROW(generateCpp(g, {a, b}, {y}), Exception);
+    }
+} // namespace infini
@@ -0,0 +1,80 @@
+#include "core/dlpack.h"
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "operators/unary.h"
+
+#include "test.h"
+
+namespace infini
+{
+    TEST(DLPack, RoundTrip)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        DLManagedTensor *exported;
+        {
+            Graph g = make_ref<GraphObj>(runtime);
+            auto x = g->addTensor({2, 3}, DataType::Float32);
+            auto y = g->addOp<ReluObj>(x, nullptr)->getOutput();
+            g->dataMalloc();
+            x->setData(IncrementalGenerator());
+            runtime->run(g);
+            exported = toDLPack(y);
+            EXPECT_EQ(exported->dl_tensor.data, y->getRawDataPtr<void *>());
+        }
+        // the exported tensor keeps the arena of the destroyed graph alive
+        const auto &dl = exported->dl_tensor;
+        EXPECT_EQ(dl.device.device_type, kDLCPU);
+        EXPECT_EQ(dl.dtype.code, kDLFloat);
+        EXPECT_EQ(dl.dtype.bits, 32);
+        ASSERT_EQ(dl.ndim, 2);
+        EXPECT_EQ(dl.shape[0], 2);
+        EXPECT_EQ(dl.shape[1], 3);
+        EXPECT_EQ(dl.strides[0], 3);
+        EXPECT_EQ(dl.strides[1], 1);
+
+        Graph g = make_ref<GraphObj>(runtime);
+        auto x = fromDLPack(g, exported);
+        EXPECT_TRUE(x->isExternal());
+        auto y = g->addOp<ReluObj>(x, nullptr)->getOutput();
+        g->dataMalloc();
+        EXPECT_EQ(x->getRawDataPtr<void *>(), dl.data);
+        runtime->run(g);
+        EXPECT_TRUE(y->equalData(vector<float>{0, 1, 2, 3, 4, 5}));
+    }
+
+    TEST(DLPack, Deleter)
+    {
+        vector<float> data = {1, 2, 3, 4};
+        vector<int64_t> shape = {4};
+        static int deleted;
+        deleted = 0;
+        auto make = [&]()
+        {
+            return new DLManagedTensor{
+                {data.data(), {kDLCPU, 0}, 1, {kDLFloat, 32, 1}, shape.data(),
+                 nullptr, 0},
+                nullptr,
+                [](DLManagedTensor *self)
+                {
+                    ++deleted;
+                    delete self;
+                }};
+        };
+
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        {
+            Graph g = make_ref<GraphObj>(runtime);
+            auto x = g->addTensor({4}, DataType::Float32);
+            bindDLPack(x, make());
+            EXPECT_EQ(x->getRawDataPtr<float *>(), data.data());
+            EXPECT_EQ(deleted, 0);
+        }
+        EXPECT_EQ(deleted, 1);
+
+        // a tensor that cannot be bound is still released
+        Graph g = make_ref<GraphObj>(runtime);
+        auto x = g->addTensor({2, 2}, DataType::Float32);
+        EXPECT_THROW(bindDLPack(x, make()), Exception);
+        EXPECT_EQ(deleted, 2);
+    }
+} // namespace infini
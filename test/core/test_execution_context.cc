@@ -0,0 +1,119 @@
+#include "core/execution_context.h"
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "operators/element_wise.h"
+#include "operators/reshape.h"
+#include "operators/unary.h"
+
+#include "test.h"
+#include <thread>
+
+namespace infini
+{
+    TEST(ExecutionContext, ConcurrentRuns)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor x = g->addTensor({64, 64}, DataType::Float32);
+        Tensor w = g->addTensor({64, 64}, DataType::Float32);
+        auto t = g->addOp<MulObj>(x, w, nullptr)->getOutput();
+        auto a = g->addOp<AddObj>(t, x, nullptr)->getOutput();
+        auto y = g->addOp<ReluObj>(a, nullptr)->getOutput();
+        vector<float> weight(64 * 64, 2.0f);
+        w->setExternalBlob(make_ref<BlobObj>(runtime, weight.data()));
+        g->dataMalloc();
+
+        constexpr int nThreads = 4;
+        vector<ExecutionContext> contexts;
+        for (int i = 0; i < nThreads; ++i)
+            contexts.emplace_back(make_ref<ExecutionContextObj>(g));
+        // weights are shared, activations are private
+        EXPECT_EQ(contexts[0]->getTensor(w)->getRawDataPtr<float *>(),
+                  weight.data());
+        EXPECT_NE(contexts[0]->getTensor(y)->getRawDataPtr<float *>(),
+                  contexts[1]->getTensor(y)->getRawDataPtr<float *>());
+        EXPECT_NE(contexts[0]->getTensor(y)->getRawDataPtr<float *>(),
+                  y->getRawDataPtr<float *>());
+
+        vector<int> failures(nThreads, 0);
+        vector<std::thread> threads;
+        for (int i = 0; i < nThreads; ++i)
+            threads.emplace_back(
+                [&, i]()
+                {
+                    auto &context = contexts[i];
+                    auto input = context->getTensor(x)->getRawDataPtr<float *>();
+                    auto output = context->getTensor(y)->getRawDataPtr<float *>();
+                    for (int run = 0; run < 50; ++run)
+                    {
+                        float value = i * 100 + run - 64;
+                        std::fill(input, input + 64 * 64, value);
+                        runtime->run(g, context);
+                        float ans = std::max(3 * value, 0.0f);
+                        for (int j = 0; j < 64 * 64; ++j)
+                            failures[i] += output[j] != ans;
+                    }
+                });
+        for (auto &thread : threads)
+            thread.join();
+        for (int i = 0; i < nThreads; ++i)
+            EXPECT_EQ(failures[i], 0);
+    }
+
+    TEST(ExecutionContext, WeightsInArena)
+    {
+        // weights set after dataMalloc live in the source's arena
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor x = g->addTensor({4, 6}, DataType::Float32);
+        Tensor w = g->addTensor({1, 6}, DataType::Float32);
+        auto t = g->addOp<MulObj>(x, w, nullptr)->getOutput();
+        auto y = g->addOp<AddObj>(t, x, nullptr)->getOutput();
+        g->dataMalloc();
+        w->setData([](void *ptr, size_t size, DataType)
+                   {
+                       auto data = static_cast<float *>(ptr);
+                       for (size_t i = 0; i < size; ++i)
+                           data[i] = float(i) - 2.5f;
+                   });
+
+        auto context = make_ref<ExecutionContextObj>(g);
+        for (int run = 0; run < 2; ++run)
+        {
+            auto fill = [run](void *ptr, size_t size, DataType)
+            {
+                auto data = static_cast<float *>(ptr);
+                for (size_t i = 0; i < size; ++i)
+                    data[i] = float(i) * 0.5f - run;
+            };
+            x->setData(fill);
+            context->getTensor(x)->setData(fill);
+            runtime->run(g);
+            runtime->run(g, context);
+            EXPECT_TRUE(context->getTensor(y)->equalData(y));
+        }
+    }
+
+    TEST(ExecutionContext, Bind)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor x = g->addTensor({2, 3}, DataType::Float32);
+        auto r = g->addOp<ReshapeObj>(x, nullptr, Shape{6})->getOutput();
+        auto y = g->addOp<ReluObj>(r, nullptr)->getOutput();
+        g->setExternal(x);
+        g->setExternal(y);
+        g->dataMalloc();
+
+        auto context = make_ref<ExecutionContextObj>(g);
+        vector<float> xData = {-1, 2, -3, 4, -5, 6}, yData(6);
+        context->bind(x, xData.data());
+        context->bind(y, yData.data());
+        EXPECT_EQ(context->getTensor(r)->getRawDataPtr<float *>(), xData.data());
+        runtime->run(g, context);
+        EXPECT_EQ(yData, (vector<float>{0, 2, 0, 4, 0, 6}));
+
+        Graph other = make_ref<GraphObj>(runtime);
+        EXPECT_THROW(runtime->run(other, context), Exception);
+    }
+} // namespace infini
@@ -1,8 +1,11 @@
 #include "core/graph.h"
 #include "core/kernel.h"
 #include "core/runtime.h"
+#include "operators/element_wise.h"
 #include "operators/matmul.h"
+#include "operators/reshape.h"
 #include "operators/transpose.h"
+#include "operators/unary.h"
 
 #include "test.h"
 
@@ -37,4 +40,194 @@ namespace infini
         EXPECT_EQ(op->getTransA(), false);
         EXPECT_EQ(op->getTransB(), true);
     }
-}
\ No newline at end of file
+
+    TEST(Graph, Schedule)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        for (auto mode : {ScheduleMode::Topological, ScheduleMode::MinPeak})
+        {
+            Graph g = make_ref<GraphObj>(runtime);
+            // Each branch expands to a 64x64 matrix and reduces it again. All
+            // expansions come first in the order topo_sort finds.
+            vector<Operator> expand, reduce;
+            for (int k = 0; k < 3; ++k)
+            {
+                Tensor col = g->addTensor({64, 1}, DataType::Float32);
+                Tensor row = g->addTensor({1, 64}, DataType::Float32);
+                expand.emplace_back(g->addOp<MatmulObj>(col, row, nullptr));
+            }
+            for (int k = 0; k < 3; ++k)
+            {
+                Tensor vec = g->addTensor({64, 1}, DataType::Float32);
+                reduce.emplace_back(g->addOp<MatmulObj>(
+                    expand[k]->getOutput(), vec, nullptr));
+            }
+            g->setScheduleMode(mode);
+            g->recordAllocTrace();
+            g->dataMalloc();
+
+            auto ops = g->getOperators();
+            Allocator allocator(runtime);
+            size_t peak = g->getAllocTrace()->replay(allocator);
+            if (mode == ScheduleMode::Topological)
+            {
+                EXPECT_EQ(ops[2], expand[2]);
+                EXPECT_EQ(peak, 10u * 256u + 3u * 16384u);
+            }
+            else
+            {
+                // every expansion is reduced before the next one runs
+                for (int k = 0; k < 3; ++k)
+                {
+                    auto it = std::find(ops.begin(), ops.end(), expand[k]);
+                    ASSERT_TRUE(it + 1 != ops.end());
+                    EXPECT_EQ(*(it + 1), reduce[k]);
+                }
+                EXPECT_EQ(peak, 12u * 256u + 16384u);
+            }
+        }
+    }
+
+    TEST(Graph, ScheduleLocality)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        // Four chains of three Relus, added step by step so that topo_sort
+        // interleaves them.
+        vector<Tensor> heads;
+        for (int k = 0; k < 4; ++k)
+            heads.emplace_back(g->addTensor({64, 1024}, DataType::Float32));
+        vector<vector<Operator>> chains(4);
+        for (int step = 0; step < 3; ++step)
+            for (int k = 0; k < 4; ++k)
+            {
+                auto input = step ? chains[k].back()->getOutput() : heads[k];
+                chains[k].emplace_back(g->addOp<ReluObj>(input, nullptr));
+            }
+        g->setScheduleMode(ScheduleMode::Locality);
+        g->schedule();
+
+        auto ops = g->getOperators();
+        for (const auto &chain : chains)
+        {
+            auto it = std::find(ops.begin(), ops.end(), chain[0]);
+            ASSERT_TRUE(ops.end() - it >= 3);
+            EXPECT_EQ(*(it + 1), chain[1]);
+            EXPECT_EQ(*(it + 2), chain[2]);
+        }
+    }
+
+    TEST(Graph, Rematerialize)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        // t is read at the start and at the end, and stays alive while e and
+        // a are both live in between.
+        auto build = [&](size_t budget)
+        {
+            Graph g = make_ref<GraphObj>(runtime);
+            Tensor x = g->addTensor({1024}, DataType::Float32);
+            Tensor y = g->addTensor({1024}, DataType::Float32);
+            auto t = g->addOp<ReluObj>(x, nullptr)->getOutput();
+            auto a = g->addOp<AddObj>(t, y, nullptr)->getOutput();
+            auto e = g->addOp<ReluObj>(a, nullptr)->getOutput();
+            auto f = g->addOp<AddObj>(a, e, nullptr)->getOutput();
+            g->addOp<AddObj>(f, t, nullptr);
+            g->dataMalloc(budget);
+            x->setData(IncrementalGenerator());
+            y->setData(IncrementalGenerator());
+            runtime->run(g);
+            return g;
+        };
+        Graph g0 = build(0), g1 = build(4 * 4096);
+        EXPECT_EQ(g0->getOperators().size(), 5u);
+        EXPECT_EQ(g1->getOperators().size(), 6u);
+        EXPECT_EQ(g1->rematerialize(4 * 4096), 4u * 4096u);
+        EXPECT_TRUE(g1->getOutputs()[0]->equalData(g0->getOutputs()[0]));
+    }
+
+    TEST(Graph, RematerializeThroughReshape)
+    {
+        // As above, but t is read late through a Reshape placed in it, which
+        // must follow the copy for t to be freed early.
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        auto build = [&](size_t budget)
+        {
+            Graph g = make_ref<GraphObj>(runtime);
+            Tensor x = g->addTensor({1024}, DataType::Float32);
+            Tensor y = g->addTensor({1024}, DataType::Float32);
+            auto t = g->addOp<ReluObj>(x, nullptr)->getOutput();
+            auto a = g->addOp<AddObj>(t, y, nullptr)->getOutput();
+            auto e = g->addOp<ReluObj>(a, nullptr)->getOutput();
+            auto f = g->addOp<AddObj>(a, e, nullptr)->getOutput();
+            auto r = g->addOp<ReshapeObj>(t, nullptr, Shape{1, 1024})
+                         ->getOutput();
+            g->addOp<AddObj>(f, r, nullptr);
+            g->dataMalloc(budget);
+            x->setData(IncrementalGenerator());
+            y->setData(IncrementalGenerator());
+            runtime->run(g);
+            return g;
+        };
+        Graph g0 = build(0), g1 = build(4 * 4096);
+        EXPECT_EQ(g1->getOperators().size(), g0->getOperators().size() + 1);
+        EXPECT_EQ(g1->rematerialize(4 * 4096), 4u * 4096u);
+        EXPECT_TRUE(g1->getOutputs()[0]->equalData(g0->getOutputs()[0]));
+    }
+
+    TEST(Graph, BoundOutputs)
+    {
+        // Relu would run in place over t and Reshape would alias its input;
+        // bound outputs must be written in their own memory instead.
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor x = g->addTensor({2, 3}, DataType::Float32);
+        auto t = g->addOp<ReluObj>(x, nullptr)->getOutput();
+        auto r = g->addOp<ReluObj>(t, nullptr)->getOutput();
+        auto y = g->addOp<ReshapeObj>(r, nullptr, Shape{6})->getOutput();
+        vector<float> rData(6), yData(6);
+        r->setExternalBlob(make_ref<BlobObj>(runtime, rData.data()));
+        y->setExternalBlob(make_ref<BlobObj>(runtime, yData.data()));
+        g->dataMalloc();
+        EXPECT_EQ(r->getRawDataPtr<float *>(), rData.data());
+        EXPECT_EQ(y->getRawDataPtr<float *>(), yData.data());
+        x->setData(IncrementalGenerator());
+        runtime->run(g);
+        vector<float> ans = {0, 1, 2, 3, 4, 5};
+        EXPECT_EQ(rData, ans);
+        EXPECT_EQ(yData, ans);
+    }
+
+    TEST(Graph, BindPerRun)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor x = g->addTensor({2, 3}, DataType::Float32);
+        auto r = g->addOp<ReshapeObj>(x, nullptr, Shape{6})->getOutput();
+        auto y = g->addOp<ReluObj>(r, nullptr)->getOutput();
+        g->setExternal(x);
+        g->setExternal(y);
+        g->dataMalloc();
+
+        for (float scale : {1.0f, -2.0f})
+        {
+            vector<float> xData(6), yData(6);
+            for (size_t i = 0; i < xData.size(); ++i)
+                xData[i] = scale * i;
+            g->bind(x, xData.data());
+            g->bind(y, yData.data());
+            // the Reshape reads the bound input in place
+            EXPECT_EQ(r->getRawDataPtr<float *>(), xData.data());
+            runtime->run(g);
+            for (size_t i = 0; i < yData.size(); ++i)
+                EXPECT_EQ(yData[i], std::max(xData[i], 0.0f));
+        }
+
+        // tensors planned in the arena cannot be bound afterwards
+        Graph h = make_ref<GraphObj>(runtime);
+        Tensor a = h->addTensor({4}, DataType::Float32);
+        h->addOp<ReluObj>(a, nullptr);
+        h->dataMalloc();
+        vector<float> aData(4);
+        EXPECT_THROW(h->bind(a, aData.data()), Exception);
+    }
+}
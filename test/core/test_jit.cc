@@ -0,0 +1,151 @@
+#include "core/jit.h"
+#include "core/runtime.h"
+#include "operators/element_wise.h"
+#include "operators/fused.h"
+#include "operators/unary.h"
+
+#include "test.h"
+#include <filesystem>
+
+namespace infini
+{
+    namespace
+    {
+        JitOptions freshCache()
+        {
+            char dir[] = "/tmp/infinitensor-jit-test-XXXXXX";
+            IT_ASSERT(mkdtemp(dir) != nullptr);
+            JitOptions options;
+            options.cacheDir = dir;
+            return options;
+        }
+
+        size_t countLibraries(const string &dir)
+        {
+            size_t n = 0;
+            for (const auto &entry : std::filesystem::directory_iterator(dir))
+                n += entry.path().extension() == ".so";
+            return n;
+        }
+
+        // Clip(Relu(x * w + b) - x) with a broadcast row 'w', column 'b' and
+        // Clip bound 'max'.
+        std::tuple<Graph, Tensor, Tensor> buildGraph(vector<float> &w,
+                                                     vector<float> &b,
+                                                     float max)
+        {
+            Runtime runtime = NativeCpuRuntimeObj::getInstance();
+            Graph g = make_ref<GraphObj>(runtime);
+            auto x = g->addTensor({4, 6}, DataType::Float32);
+            auto tw = g->addTensor({1, 6}, DataType::Float32);
+            auto tb = g->addTensor({4, 1}, DataType::Float32);
+            tw->setExternalBlob(make_ref<BlobObj>(runtime, w.data()));
+            tb->setExternalBlob(make_ref<BlobObj>(runtime, b.data()));
+            auto t0 = g->addOp<MulObj>(x, tw, nullptr)->getOutput();
+            auto t1 = g->addOp<AddObj>(t0, tb, nullptr)->getOutput();
+            auto t2 = g->addOp<ReluObj>(t1, nullptr)->getOutput();
+            auto t3 = g->addOp<SubObj>(t2, x, nullptr)->getOutput();
+            auto y = g->addOp<ClipObj>(t3, nullptr, -2.0f, max)->getOutput();
+            return {g, x, y};
+        }
+    } // namespace
+
+    TEST(Jit, FusedMatchesKernels)
+    {
+        vector<float> w = {1, -2, 3, -4, 5, -6}, b = {0.5, -1, 2, -3};
+        auto [ref, xRef, yRef] = buildGraph(w, b, 4.0f);
+        auto [g, x, y] = buildGraph(w, b, 4.0f);
+        auto options = freshCache();
+        EXPECT_EQ(fuseElementWise(g, options), 1u);
+        ASSERT_EQ(g->getOperators().size(), 1u);
+        auto op = g->getOperators()[0];
+        EXPECT_EQ(op->getOpType(), OpType::FusedElementWise);
+        EXPECT_EQ(op->getInputs().size(), 3u);
+        EXPECT_EQ(op->getOutput(), y);
+
+        ref->dataMalloc();
+        g->dataMalloc();
+        xRef->setData(IncrementalGenerator());
+        x->setData(IncrementalGenerator());
+        auto runtime = g->getRuntime();
+        runtime->run(ref);
+        runtime->run(g);
+        EXPECT_TRUE(y->equalData(yRef));
+        std::filesystem::remove_all(options.cacheDir);
+    }
+
+    TEST(Jit, Cache)
+    {
+        vector<float> w(6, 1.0f), b(4, 0.0f);
+        auto options = freshCache();
+        auto [g0, x0, y0] = buildGraph(w, b, 4.0f);
+        fuseElementWise(g0, options);
+        EXPECT_EQ(countLibraries(options.cacheDir), 1u);
+        auto built = std::filesystem::last_write_time(
+            std::filesystem::directory_iterator(options.cacheDir)->path());
+
+        // the same region is loaded from the cache
+        auto [g1, x1, y1] = buildGraph(w, b, 4.0f);
+        EXPECT_EQ(fuseElementWise(g1, options), 1u);
+        EXPECT_EQ(countLibraries(options.cacheDir), 1u);
+        EXPECT_EQ(std::filesystem::last_write_time(
+                      std::filesystem::directory_iterator(options.cacheDir)
+                          ->path()),
+                  built);
+
+        // constants are part of the signature
+        auto [g2, x2, y2] = buildGraph(w, b, 3.0f);
+        EXPECT_EQ(fuseElementWise(g2, options), 1u);
+        EXPECT_EQ(countLibraries(options.cacheDir), 2u);
+        std::filesystem::remove_all(options.cacheDir);
+    }
+
+    TEST(Jit, PrivateCache)
+    {
+        namespace fs = std::filesystem;
+        vector<float> w(6, 1.0f), b(4, 0.0f);
+        auto options = freshCache();
+        auto root = options.cacheDir;
+
+        // a missing directory is created for this user only
+        options.cacheDir = root + "/nested/jit";
+        auto [g0, x0, y0] = buildGraph(w, b, 4.0f);
+        EXPECT_EQ(fuseElementWise(g0, options), 1u);
+        EXPECT_EQ(fs::status(options.cacheDir).permissions(),
+                  fs::perms::owner_all);
+
+        // an existing one open to others is closed before anything is loaded
+        fs::permissions(options.cacheDir, fs::perms::all);
+        auto [g1, x1, y1] = buildGraph(w, b, 4.0f);
+        EXPECT_EQ(fuseElementWise(g1, options), 1u);
+        EXPECT_EQ(fs::status(options.cacheDir).permissions(),
+                  fs::perms::owner_all);
+        fs::remove_all(root);
+    }
+
+    TEST(Jit, SharedIntermediate)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        auto x = g->addTensor({8}, DataType::Float32);
+        auto t = g->addOp<ReluObj>(x, nullptr)->getOutput();
+        auto a = g->addOp<AddObj>(t, x, nullptr)->getOutput();
+        auto m = g->addOp<MulObj>(t, x, nullptr)->getOutput();
+        auto y = g->addOp<SubObj>(a, m, nullptr)->getOutput();
+        auto options = freshCache();
+        // 't' is read twice and stays stored; a, m and y fuse
+        EXPECT_EQ(fuseElementWise(g, options), 1u);
+        EXPECT_EQ(g->getOperators().size(), 2u);
+        g->dataMalloc();
+        x->setData([](void *ptr, size_t size, DataType)
+                   {
+                       auto data = static_cast<float *>(ptr);
+                       for (size_t i = 0; i < size; ++i)
+                           data[i] = float(i) - 4;
+                   });
+        runtime->run(g);
+        EXPECT_TRUE(y->equalData(
+            vector<float>{-4, -3, -2, -1, 0, 1, 0, -3}));
+        std::filesystem::remove_all(options.cacheDir);
+    }
+} // namespace infini
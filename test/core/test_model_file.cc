@@ -0,0 +1,55 @@
+#include "core/graph.h"
+#include "core/model_file.h"
+#include "core/runtime.h"
+#include "operators/concat.h"
+#include "operators/element_wise.h"
+#include "operators/transpose.h"
+#include "operators/unary.h"
+
+#include "test.h"
+
+namespace infini
+{
+    TEST(ModelFile, SaveAndLoad)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        auto x = g->addTensor({2, 3, 4}, DataType::Float32);
+        auto w = g->addTensor({2, 3, 4}, DataType::Float32);
+        auto sum = g->addOp<AddObj>(x, w, nullptr)->getOutput();
+        auto clip = g->addOp<ClipObj>(sum, nullptr, 1.0f, std::nullopt)
+                        ->getOutput();
+        auto t = g->addOp<TransposeObj>(clip, nullptr, Shape{0, 2, 1})
+                     ->getOutput();
+        auto y = g->addOp<ConcatObj>(TensorVec{t, t}, nullptr, 1)->getOutput();
+        g->dataMalloc();
+        x->setData(IncrementalGenerator());
+        w->setData(IncrementalGenerator());
+        runtime->run(g);
+
+        string path = testing::TempDir() + "model.it";
+        saveModel(g, path, {w});
+        Graph loaded = loadModel(path, runtime);
+        ASSERT_EQ(loaded->getTensors().size(), g->getTensors().size());
+        ASSERT_EQ(loaded->getOperators().size(), 4u);
+        auto clipOp = as<ClipObj>(loaded->getOperators()[1]);
+        EXPECT_EQ(clipOp->getMin(), 1.0f);
+        EXPECT_FALSE(clipOp->getMax().has_value());
+        auto transposeOp = as<TransposeObj>(loaded->getOperators()[2]);
+        EXPECT_EQ(transposeOp->getPermute(), (vector<int>{0, 2, 1}));
+
+        // the weight points into the file, aligned, and stays out of the arena
+        auto loadedX = loaded->getTensors()[0];
+        auto loadedW = loaded->getTensors()[1];
+        EXPECT_FALSE(loadedX->isExternal());
+        ASSERT_TRUE(loadedW->isExternal());
+        auto weightPtr = loadedW->getRawDataPtr<float *>();
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(weightPtr) % 64, 0u);
+        loaded->dataMalloc();
+        EXPECT_EQ(loadedW->getRawDataPtr<float *>(), weightPtr);
+
+        loadedX->setData(IncrementalGenerator());
+        runtime->run(loaded);
+        EXPECT_TRUE(loaded->getOutputs()[0]->equalData(y));
+    }
+} // namespace infini
@@ -0,0 +1,176 @@
+#include "core/graph.h"
+#include "core/onnx.h"
+#include "core/runtime.h"
+#include "operators/matmul.h"
+
+#include "test.h"
+#include <fstream>
+
+namespace infini
+{
+    namespace
+    {
+        // Just enough of the protobuf wire format to write ONNX models.
+        string varint(uint64_t value)
+        {
+            string ret;
+            do
+            {
+                uint8_t byte = value & 0x7f;
+                value >>= 7;
+                ret += char(value ? byte | 0x80 : byte);
+            } while (value);
+            return ret;
+        }
+
+        string field(int number, uint64_t value)
+        {
+            return varint(number << 3) + varint(value);
+        }
+
+        string field(int number, const string &bytes)
+        {
+            return varint(number << 3 | 2) + varint(bytes.size()) + bytes;
+        }
+
+        string packed(int number, const vector<int64_t> &values)
+        {
+            string data;
+            for (auto v : values)
+                data += varint(v);
+            return field(number, data);
+        }
+
+        template <typename T>
+        string rawBytes(const vector<T> &values)
+        {
+            return string(reinterpret_cast<const char *>(values.data()),
+                          values.size() * sizeof(T));
+        }
+
+        string tensorProto(const string &name, int dtype, vector<int64_t> dims,
+                           const string &data)
+        {
+            return packed(1, dims) + field(2, dtype) + field(8, name) + data;
+        }
+
+        string node(const string &op, vector<string> inputs,
+                    vector<string> outputs, const string &attributes = "")
+        {
+            string ret;
+            for (const auto &input : inputs)
+                ret += field(1, input);
+            for (const auto &output : outputs)
+                ret += field(2, output);
+            return ret + field(4, op) + attributes;
+        }
+
+        string valueInfo(const string &name, int dtype, vector<int64_t> dims)
+        {
+            string shape;
+            for (auto d : dims)
+                shape += field(1, field(1, d));
+            return field(1, name) +
+                   field(2, field(1, field(1, dtype) + field(2, shape)));
+        }
+
+        string writeModel(const string &name, const string &graph)
+        {
+            string path = testing::TempDir() + name;
+            std::ofstream file(path, std::ios::binary);
+            file << field(1, 8) + field(7, graph);
+            return path;
+        }
+    } // namespace
+
+    TEST(Onnx, Import)
+    {
+        // y = Reshape(Relu(x * w + b), [-1])
+        vector<float> w = {1, -2, 0.5f}, b = {1, 0, -3};
+        string bData;
+        for (auto v : b)
+            bData += rawBytes(vector<float>{v});
+        string graph =
+            field(1, node("Mul", {"x", "w"}, {"mul"})) +
+            field(1, node("Add", {"mul", "b"}, {"add"})) +
+            field(1, node("Relu", {"add"}, {"relu"})) +
+            field(1, node("Constant", {}, {"shape"},
+                          field(5, field(1, "value") +
+                                       field(5, tensorProto("", 7, {1},
+                                                            packed(7, {-1})))))) +
+            field(1, node("Reshape", {"relu", "shape"}, {"y"})) +
+            field(5, tensorProto("w", 1, {3}, field(9, rawBytes(w)))) +
+            field(5, tensorProto("b", 1, {3}, field(4, bData))) +
+            field(11, valueInfo("x", 1, {2, 3})) +
+            field(12, valueInfo("y", 1, {6}));
+        auto path = writeModel("import.onnx", graph);
+        EXPECT_TRUE(unsupportedOnnxOperators(path).empty());
+
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        auto model = importOnnx(path, runtime);
+        auto g = model.graph;
+        ASSERT_EQ(model.inputs.size(), 1u);
+        ASSERT_EQ(model.outputs.size(), 1u);
+        EXPECT_EQ(model.outputs[0]->getDims(), (Shape{6}));
+        // the shape became an attribute of Reshape
+        EXPECT_EQ(g->getOperators().size(), 4u);
+
+        // weights are bound, aligned, and stay out of the arena
+        size_t weights = 0;
+        for (const auto &tensor : g->getTensors())
+        {
+            if (!tensor->isExternal())
+                continue;
+            ++weights;
+            auto ptr = tensor->getRawDataPtr<void *>();
+            EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % 64, 0u);
+        }
+        EXPECT_EQ(weights, 2u);
+
+        g->dataMalloc();
+        model.inputs[0]->setData(IncrementalGenerator());
+        runtime->run(g);
+        vector<float> ans;
+        for (int i = 0; i < 6; ++i)
+            ans.emplace_back(std::max(float(i) * w[i % 3] + b[i % 3], 0.0f));
+        EXPECT_TRUE(model.outputs[0]->equalData(ans));
+    }
+
+    TEST(Onnx, Gemm)
+    {
+        string graph =
+            field(1, node("Gemm", {"x", "w", "b"}, {"y"},
+                          field(5, field(1, "transB") + field(3, 1)))) +
+            field(5, tensorProto("w", 1, {4, 3},
+                                 field(9, rawBytes(vector<float>(12))))) +
+            field(5, tensorProto("b", 1, {4},
+                                 field(9, rawBytes(vector<float>(4))))) +
+            field(11, valueInfo("x", 1, {2, 3})) +
+            field(12, valueInfo("y", 1, {2, 4}));
+        auto path = writeModel("gemm.onnx", graph);
+        auto model = importOnnx(path, NativeCpuRuntimeObj::getInstance());
+        const auto &ops = model.graph->getOperators();
+        ASSERT_EQ(ops.size(), 2u);
+        ASSERT_EQ(ops[0]->getOpType(), OpType::MatMul);
+        EXPECT_TRUE(as<MatmulObj>(ops[0])->getTransB());
+        EXPECT_EQ(ops[1]->getOpType(), OpType::Add);
+        EXPECT_EQ(model.outputs[0]->getDims(), (Shape{2, 4}));
+    }
+
+    TEST(Onnx, UnsupportedOperators)
+    {
+        string graph =
+            field(1, node("Conv", {"x", "w"}, {"conv"})) +
+            field(1, node("Relu", {"conv"}, {"relu"})) +
+            field(1, node("Softmax", {"relu"}, {"y"})) +
+            field(1, node("Conv", {"y", "w"}, {"z"})) +
+            field(5, tensorProto("w", 1, {1},
+                                 field(9, rawBytes(vector<float>{1})))) +
+            field(11, valueInfo("x", 1, {1}));
+        auto path = writeModel("unsupported.onnx", graph);
+        EXPECT_EQ(unsupportedOnnxOperators(path),
+                  (vector<string>{"Conv", "Softmax"}));
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        EXPECT_THROW(importOnnx(path, runtime), Exception);
+    }
+} // namespace infini
@@ -0,0 +1,118 @@
+#include "core/execution_context.h"
+#include "core/replay.h"
+#include "core/runtime.h"
+#include "operators/element_wise.h"
+#include "operators/reshape.h"
+#include "operators/transpose.h"
+#include "operators/unary.h"
+
+#include "test.h"
+
+namespace infini
+{
+    namespace
+    {
+        // Exercises resolved launches, strided and broadcast indexing, a
+        // kernel that replays through compute and a reshape with nothing to
+        // do.
+        std::tuple<Graph, Tensor, Tensor> buildGraph(vector<float> &weight)
+        {
+            Runtime runtime = NativeCpuRuntimeObj::getInstance();
+            Graph g = make_ref<GraphObj>(runtime);
+            auto x = g->addTensor({4, 6}, DataType::Float32);
+            auto w = g->addTensor({1, 6}, DataType::Float32);
+            w->setExternalBlob(make_ref<BlobObj>(runtime, weight.data()));
+            auto t0 = g->addOp<MulObj>(x, w, nullptr)->getOutput();
+            auto t1 = g->addOp<AddObj>(t0, x, nullptr)->getOutput();
+            auto t2 = g->addOp<TransposeObj>(t1, nullptr, Shape{1, 0})
+                          ->getOutput();
+            auto t3 = g->addOp<ClipObj>(t2, nullptr, -4.0f, 20.0f)->getOutput();
+            auto t4 = g->addOp<ReshapeObj>(t3, nullptr, Shape{24})->getOutput();
+            auto y = g->addOp<ReluObj>(t4, nullptr)->getOutput();
+            g->dataMalloc();
+            return {g, x, y};
+        }
+    } // namespace
+
+    TEST(Replay, MatchesRun)
+    {
+        vector<float> weight = {1, -2, 3, -4, 5, -6};
+        auto [g, x, y] = buildGraph(weight);
+        auto runtime = g->getRuntime();
+        ReplayObj replay(g);
+        for (int round = 0; round < 3; ++round)
+        {
+            x->setData([round](void *ptr, size_t size, DataType)
+                       {
+                           auto data = static_cast<float *>(ptr);
+                           for (size_t i = 0; i < size; ++i)
+                               data[i] = float(i) * 0.5f - round * 2;
+                       });
+            runtime->run(g);
+            auto ptr = y->getRawDataPtr<float *>();
+            vector<float> expected(ptr, ptr + y->size());
+            std::fill_n(ptr, y->size(), -1.0f);
+            replay.run();
+            EXPECT_TRUE(y->equalData(expected));
+        }
+    }
+
+    TEST(Replay, ExecutionContext)
+    {
+        vector<float> weight = {1, -2, 3, -4, 5, -6};
+        auto [g, x, y] = buildGraph(weight);
+        auto runtime = g->getRuntime();
+        x->setData(IncrementalGenerator());
+        runtime->run(g);
+
+        auto context = make_ref<ExecutionContextObj>(g);
+        ReplayObj replay(context->getGraph());
+        context->getTensor(x)->setData(IncrementalGenerator());
+        replay.run();
+        EXPECT_TRUE(context->getTensor(y)->equalData(y));
+        EXPECT_NE(context->getTensor(y)->getRawDataPtr<float *>(),
+                  y->getRawDataPtr<float *>());
+    }
+
+    TEST(Replay, ClipInfinity)
+    {
+        // a missing bound leaves infinities as compute does
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        auto x = g->addTensor(Shape{4}, DataType::Float32);
+        auto hi = g->addOp<ClipObj>(x, nullptr, std::nullopt, 1.0f)->getOutput();
+        auto lo = g->addOp<ClipObj>(x, nullptr, -1.0f, std::nullopt)->getOutput();
+        g->dataMalloc();
+        float inf = std::numeric_limits<float>::infinity();
+        x->setData([inf](void *ptr, size_t, DataType)
+                   {
+                       auto data = static_cast<float *>(ptr);
+                       data[0] = -inf;
+                       data[1] = inf;
+                       data[2] = 0.5f;
+                       data[3] = -3.0f;
+                   });
+        runtime->run(g);
+        auto hiPtr = hi->getRawDataPtr<float *>();
+        auto loPtr = lo->getRawDataPtr<float *>();
+        vector<float> hiExpected(hiPtr, hiPtr + 4), loExpected(loPtr, loPtr + 4);
+        EXPECT_EQ(hiExpected, (vector<float>{-inf, 1.0f, 0.5f, -3.0f}));
+        EXPECT_EQ(loExpected, (vector<float>{-1.0f, inf, 0.5f, -1.0f}));
+
+        ReplayObj replay(g);
+        std::fill_n(hiPtr, 4, 0.0f);
+        std::fill_n(loPtr, 4, 0.0f);
+        replay.run();
+        EXPECT_EQ(vector<float>(hiPtr, hiPtr + 4), hiExpected);
+        EXPECT_EQ(vector<float>(loPtr, loPtr + 4), loExpected);
+    }
+
+    TEST(Replay, Unplanned)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        auto x = g->addTensor(Shape{4}, DataType::Float32);
+        g->addOp<ReluObj>(x, nullptr);
+        EXPECT_THROW(ReplayObj{g}, Exception);
+    }
+} // namespace infini
@@ -0,0 +1,109 @@
+#include "core/graph.h"
+#include "core/kernel.h"
+#include "core/runtime.h"
+#include "operators/concat.h"
+#include "operators/element_wise.h"
+#include "operators/transpose.h"
+#include "operators/unary.h"
+
+#include "test.h"
+#include <cstdlib>
+#include <sched.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace infini
+{
+    namespace
+    {
+        // The affinity of each thread of an OpenMP team of 'n' threads.
+        vector<cpu_set_t> teamAffinity(int n)
+        {
+            vector<cpu_set_t> masks(n);
+#ifdef _OPENMP
+#pragma omp parallel num_threads(n)
+            sched_getaffinity(0, sizeof(cpu_set_t),
+                              &masks[omp_get_thread_num()]);
+#else
+            sched_getaffinity(0, sizeof(cpu_set_t), &masks[0]);
+#endif
+            return masks;
+        }
+    } // namespace
+
+    TEST(Runtime, NumaNode)
+    {
+        auto nodes = NumaCpuRuntimeObj::getNodes();
+        ASSERT_FALSE(nodes.empty());
+        auto runtime = NumaCpuRuntimeObj::getInstance(nodes[0]);
+        EXPECT_EQ(runtime, NumaCpuRuntimeObj::getInstance(nodes[0]));
+        ASSERT_FALSE(runtime->getCpus().empty());
+
+        int nThreads = runtime->getCpus().size();
+        auto before = teamAffinity(nThreads);
+
+        Graph g = make_ref<GraphObj>(runtime);
+        auto input = g->addTensor({4, 1 << 20}, DataType::Float32);
+        auto op = g->addOp<ReluObj>(input, nullptr);
+        g->dataMalloc();
+        input->setData(IncrementalGenerator());
+        runtime->run(g);
+
+        vector<float> ans(input->size());
+        for (size_t i = 0; i < ans.size(); ++i)
+            ans[i] = i;
+        EXPECT_TRUE(op->getOutput()->equalData(ans));
+
+        // the calling thread and the pooled workers get their own affinity
+        // back after the run
+        auto after = teamAffinity(nThreads);
+        for (int i = 0; i < nThreads; ++i)
+            EXPECT_TRUE(CPU_EQUAL(&before[i], &after[i]));
+    }
+
+    TEST(Runtime, OutOfCore)
+    {
+        // Tiles of 1000 bytes do not divide the operands, the last one is
+        // partial.
+        Runtime outOfCore =
+            make_ref<OutOfCoreCpuRuntimeObj>(testing::TempDir(), 1000);
+        Runtime native = NativeCpuRuntimeObj::getInstance();
+        auto build = [](Runtime runtime)
+        {
+            Graph g = make_ref<GraphObj>(runtime);
+            auto a = g->addTensor({3, 4, 257}, DataType::Float32);
+            auto b = g->addTensor({3, 4, 257}, DataType::Float32);
+            auto sum = g->addOp<AddObj>(a, b, nullptr)->getOutput();
+            auto t = g->addOp<TransposeObj>(sum, nullptr, Shape{2, 0, 1})
+                         ->getOutput();
+            auto cat = g->addOp<ConcatObj>(TensorVec{t, t}, nullptr, 1)
+                           ->getOutput();
+            auto r = g->addOp<ReluObj>(cat, nullptr)->getOutput();
+            auto c = g->addOp<ClipObj>(r, nullptr, 100.f, 5000.f)->getOutput();
+            g->dataMalloc();
+            a->setData(IncrementalGenerator());
+            b->setData(IncrementalGenerator());
+            runtime->run(g);
+            return std::make_pair(g, c);
+        };
+        auto [g0, c0] = build(native);
+        auto [g1, c1] = build(outOfCore);
+        EXPECT_EQ(outOfCore->getTileBytes(), 1000u);
+        EXPECT_TRUE(c1->equalData(c0));
+    }
+
+    TEST(Runtime, OutOfCoreDirectory)
+    {
+        auto saved = std::getenv("TMPDIR");
+        string tmpdir = saved ? saved : "";
+        setenv("TMPDIR", testing::TempDir().c_str(), 1);
+        EXPECT_EQ(OutOfCoreCpuRuntimeObj::defaultDirectory(),
+                  testing::TempDir());
+        unsetenv("TMPDIR");
+        EXPECT_EQ(OutOfCoreCpuRuntimeObj::defaultDirectory(), "/var/tmp");
+        if (saved)
+            setenv("TMPDIR", tmpdir.c_str(), 1);
+    }
+
+} // namespace infini
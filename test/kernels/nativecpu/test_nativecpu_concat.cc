@@ -1,6 +1,7 @@
 #include "core/graph.h"
 #include "core/runtime.h"
 #include "operators/concat.h"
+#include "operators/unary.h"
 
 #include "test.h"
 
@@ -25,4 +26,32 @@ TEST(Concat, NativeCpu) {
                       6, 7, 8, 1, 1, 1, 9, 10, 11, 1, 1, 1}));
 }
 
+TEST(Concat, NativeCpuZeroCopy) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+
+    auto t1 = g->addTensor({1, 2, 3}, DataType::Float32);
+    auto t2 = g->addTensor({1, 1, 3}, DataType::Float32);
+    auto t3 = g->addTensor({1, 2, 3}, DataType::Float32);
+    auto r1 = g->addOp<ReluObj>(t1, nullptr);
+    auto r2 = g->addOp<ReluObj>(t2, nullptr);
+    auto op = g->addOp<ConcatObj>(
+        TensorVec{r1->getOutput(), r2->getOutput(), t3}, nullptr, 1);
+    g->dataMalloc();
+    t1->setData(IncrementalGenerator());
+    t2->setData(OneGenerator());
+    t3->setData(IncrementalGenerator());
+
+    // The Relu outputs live inside the Concat output, the graph input t3
+    // still has to be copied.
+    auto outPtr = op->getOutput()->getRawDataPtr<float *>();
+    EXPECT_EQ(r1->getOutput()->getRawDataPtr<float *>(), outPtr);
+    EXPECT_EQ(r2->getOutput()->getRawDataPtr<float *>(), outPtr + 6);
+    EXPECT_NE(t3->getRawDataPtr<float *>(), outPtr + 9);
+
+    runtime->run(g);
+    EXPECT_TRUE(op->getOutput()->equalData(
+        vector<float>{0, 1, 2, 3, 4, 5, 1, 1, 1, 0, 1, 2, 3, 4, 5}));
+}
+
 } // namespace infini
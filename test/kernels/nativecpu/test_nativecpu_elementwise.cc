@@ -1,6 +1,7 @@
 #include "core/graph.h"
 #include "core/runtime.h"
 #include "operators/element_wise.h"
+#include "operators/unary.h"
 
 #include "test.h"
 
@@ -41,4 +42,32 @@ TEST(ElementWise, NativeCpu) {
         Shape{2, 1, 1}, ExpectOutput{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11});
 }
 
+TEST(ElementWise, NativeCpuInplace) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto t1 = g->addTensor({2, 3}, DataType::Float32);
+    auto t2 = g->addTensor({3}, DataType::Float32);
+    auto t3 = g->addTensor({2, 3}, DataType::Float32);
+
+    auto sub = g->addOp<SubObj>(t1, t2, nullptr);
+    auto relu = g->addOp<ReluObj>(sub->getOutput(), nullptr);
+    auto mul = g->addOp<MulObj>(relu->getOutput(), t3, nullptr);
+    g->dataMalloc();
+    t1->setData(IncrementalGenerator());
+    t2->setData(ValGenerator<2>());
+    t3->setData(IncrementalGenerator());
+
+    // Relu and Mul overwrite the intermediate they consume, graph inputs
+    // are never overwritten.
+    auto ptr = sub->getOutput()->getRawDataPtr<void *>();
+    EXPECT_EQ(relu->getOutput()->getRawDataPtr<void *>(), ptr);
+    EXPECT_EQ(mul->getOutput()->getRawDataPtr<void *>(), ptr);
+    EXPECT_NE(t1->getRawDataPtr<void *>(), ptr);
+
+    runtime->run(g);
+    EXPECT_TRUE(mul->getOutput()->equalData(
+        ExpectOutput{0, 0, 0, 3, 8, 15}));
+    EXPECT_TRUE(t1->equalData(ExpectOutput{0, 1, 2, 3, 4, 5}));
+}
+
 } // namespace infini
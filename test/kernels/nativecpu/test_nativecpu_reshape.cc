@@ -0,0 +1,36 @@
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "operators/reshape.h"
+#include "operators/unary.h"
+
+#include "test.h"
+
+namespace infini {
+
+TEST(Reshape, NativeCpu) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+
+    auto input = g->addTensor({2, 3, 4}, DataType::Float32);
+    auto relu = g->addOp<ReluObj>(input, nullptr);
+    auto reshape = g->addOp<ReshapeObj>(relu->getOutput(), nullptr, Shape{6, 4});
+    auto unsqueeze =
+        g->addOp<UnsqueezeObj>(reshape->getOutput(), nullptr, vector<int>{0});
+    auto flatten = g->addOp<FlattenObj>(unsqueeze->getOutput(), nullptr, 1);
+    g->dataMalloc();
+    input->setData(IncrementalGenerator());
+
+    // Shape-only operators alias the memory of their input.
+    auto ptr = relu->getOutput()->getRawDataPtr<void *>();
+    EXPECT_EQ(reshape->getOutput()->getRawDataPtr<void *>(), ptr);
+    EXPECT_EQ(flatten->getOutput()->getRawDataPtr<void *>(), ptr);
+
+    runtime->run(g);
+    vector<float> ans(24);
+    for (size_t i = 0; i < ans.size(); ++i)
+        ans[i] = i;
+    EXPECT_EQ(flatten->getOutput()->getDims(), (Shape{1, 24}));
+    EXPECT_TRUE(flatten->getOutput()->equalData(ans));
+}
+
+} // namespace infini
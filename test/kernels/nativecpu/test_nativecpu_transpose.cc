@@ -1,7 +1,9 @@
 #include "core/graph.h"
 #include "core/kernel.h"
 #include "core/runtime.h"
+#include "operators/element_wise.h"
 #include "operators/transpose.h"
+#include "operators/unary.h"
 
 #include "test.h"
 
@@ -24,4 +26,35 @@ TEST(Transpose, NativeCpu) {
                                                           8, 9, 10, 11, 20, 21, 22, 23}));
 }
 
+TEST(Transpose, NativeCpuView) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+
+    Shape permute = {0, 2, 1, 3};
+    auto input = g->addTensor({1, 2, 3, 4}, DataType::Float32);
+    auto bias = g->addTensor({4}, DataType::Float32);
+    auto transpose = g->addOp<TransposeObj>(input, nullptr, permute);
+    auto relu = g->addOp<ReluObj>(transpose->getOutput(), nullptr);
+    auto add = g->addOp<AddObj>(transpose->getOutput(), bias, nullptr);
+    g->optimize();
+    g->dataMalloc();
+    input->setData(IncrementalGenerator());
+    bias->setData(OneGenerator());
+
+    // Both consumers read strides, so the transpose moves no data.
+    auto view = transpose->getOutput();
+    EXPECT_TRUE(view->isView());
+    EXPECT_EQ(view->getStride(), (Shape{24, 4, 12, 1}));
+    EXPECT_EQ(view->getRawDataPtr<void *>(), input->getRawDataPtr<void *>());
+
+    runtime->run(g);
+
+    vector<float> ans{0, 1, 2,  3,  12, 13, 14, 15, 4,  5,  6,  7,
+                      16, 17, 18, 19, 8, 9, 10, 11, 20, 21, 22, 23};
+    EXPECT_TRUE(relu->getOutput()->equalData(ans));
+    for (auto &v : ans)
+        v += 1;
+    EXPECT_TRUE(add->getOutput()->equalData(ans));
+}
+
 } // namespace infini
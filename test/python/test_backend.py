@@ -0,0 +1,48 @@
+import unittest
+
+import numpy as np
+
+import backend
+
+
+class TestBind(unittest.TestCase):
+    def build(self):
+        g = backend.Graph(backend.cpu_runtime())
+        x = g.tensor([2, 3])
+        y = g.relu(x)
+        g.set_external(x)
+        g.set_external(y)
+        g.data_malloc()
+        return g, x, y
+
+    def test_numpy_in_place(self):
+        g, x, y = self.build()
+        a = np.arange(-3, 3, dtype=np.float32).reshape(2, 3)
+        # Inputs are only read, a read-only array binds as well.
+        a.flags.writeable = False
+        out = np.full((2, 3), -1, dtype=np.float32)
+        g.bind(x, a)
+        g.bind(y, out)
+        g.runtime.run(g)
+        np.testing.assert_array_equal(out, np.maximum(a, 0))
+        # The tensors read and write the arrays themselves.
+        self.assertTrue(np.shares_memory(np.asarray(x), a))
+        self.assertTrue(np.shares_memory(np.asarray(y), out))
+
+    def test_read_only_output(self):
+        g, x, y = self.build()
+        out = np.zeros((2, 3), dtype=np.float32)
+        out.flags.writeable = False
+        with self.assertRaises(BufferError):
+            g.bind(y, out)
+
+    def test_mismatch(self):
+        g, x, y = self.build()
+        with self.assertRaises(RuntimeError):
+            g.bind(x, np.zeros((3, 2), dtype=np.float32))
+        with self.assertRaises(RuntimeError):
+            g.bind(x, np.zeros((2, 3), dtype=np.float64))
+
+
+if __name__ == "__main__":
+    unittest.main()